@@ -7,7 +7,7 @@ CONFIG(debug, debug|release) {
 else {
 	TARGET = gtestrunner
 }
-QT += core gui widgets xml
+QT += core gui widgets xml network concurrent
 INCLUDEPATH += include
 HEADERS += include/GTestSuiteResults.h \
     include/GTestResults.h \
@@ -20,7 +20,21 @@ HEADERS += include/GTestSuiteResults.h \
     include/GTestRunner.h \
     include/TestTreeModel.h \
     include/TreeModel.h \
-    include/TreeItem.h
+    include/TreeItem.h \
+    include/TestScheduler.h \
+    include/TestHistory.h \
+    include/TestPartitioner.h \
+    include/GTestFilter.h \
+    include/ListingCache.h \
+    include/TestStore.h \
+    include/TestEngine.h \
+    include/TestEventRecord.h \
+    include/OutputCapture.h \
+    include/LogSource.h \
+    include/LogView.h \
+    include/JsonStreamReader.h \
+    include/GTestJsonParser.h \
+    include/ResultArena.h
 SOURCES += src/GTestResults.cpp \
     src/GTestSuiteResults.cpp \
     src/GTestSuite.cpp \
@@ -32,7 +46,20 @@ SOURCES += src/GTestResults.cpp \
     src/GTestRunner.cpp \
     src/TestTreeModel.cpp \
     src/TreeModel.cpp \
-    src/TreeItem.cpp
+    src/TreeItem.cpp \
+    src/TestScheduler.cpp \
+    src/TestHistory.cpp \
+    src/TestPartitioner.cpp \
+    src/GTestFilter.cpp \
+    src/ListingCache.cpp \
+    src/TestStore.cpp \
+    src/TestEngine.cpp \
+    src/OutputCapture.cpp \
+    src/LogSource.cpp \
+    src/LogView.cpp \
+    src/JsonStreamReader.cpp \
+    src/GTestJsonParser.cpp \
+    src/ResultArena.cpp
 FORMS += resources/gtestrunner.ui
 UI_HEADERS_DIR = include
 UI_SOURCES_DIR = src
@@ -17,72 +17,63 @@
 #ifndef GTEST_H_
 #define GTEST_H_
 
-#include <QMetaType>
-#include <QObject>
 #include <QString>
+#include <qnamespace.h>
 
-class GTestResults;
-class GTestSuite;
+#include "TestStore.h"
 
 /*! \brief This class logically represents a single unit test.
  *
  * This class attempts to mirror what an actual unit test is comprised of.
- * For example, it contains a name and a result and the varying methods
- * to access and modify these elements. However, like a real unit test,
- * it is usually contained within a test suite which then requires an
- * executable to run. Thus, this structure is reflected in objects of this
- * type are held by a GTestSuite object which are then held by a
- * GTestExecutable object.
+ * For example, it contains a name, a check state and a result status.
+ * However, like a real unit test, it is usually contained within a test
+ * suite which then requires an executable to run. Thus, a GTest is a
+ * lightweight view of a test held in the TestStore of its GTestExecutable.
+ * It holds no state of its own and is cheap to copy, so there needn't be
+ * an object per test however many tests an executable has.
+ * \see TestStore
  */
-class GTest : public QObject {
-
-Q_OBJECT
+class GTest {
 
 protected:
-    //QString name; we use QObject::objectName
-	/**< Represents the name of the test.
-					 *   In the case of the GTestExecutable class, this holds
-					 *   the executable's file path.
-					 */
+	const TestStore* store;	//!< The store holding the test.
+	int id;					//!< The id of the test in the store.
 
-	GTestResults* testResults; /**< Pointer to a test result object
-                                *   This is null until the test is actually run.
-								*/
+public:
+	GTest(const TestStore* store = 0, int id = -1);
 
-signals:
-	void requestingRun(QString testName, QString caseName = QString()); //!< Sends a request to the parent GTest
-	void testResultsReady();//!< Sends a notification that the test results have been received and are ready to be read.
+	Qt::CheckState getCheckState() const;
+	QString getFullName() const;
+	int getId() const;
+	QString getName() const;
+	TestStore::STATUS getStatus() const;
+	bool isValid() const;
+};
 
-public:
-    GTest(QObject* parent, QString name = QString());
-    GTest(GTestSuite* parent, QString name = QString());
-	virtual ~GTest();
-    GTestResults* getTestResults() const;
+/*! \brief Retrieves the check state of the test.
+ */
+inline Qt::CheckState GTest::getCheckState() const { return store->getTestCheckState(id); }
 
-	virtual void receiveTestResults(GTestResults* testResults);
-	virtual void run();
+/*! \brief Retrieves the name of the test in the form "suitename.testname".
+ */
+inline QString GTest::getFullName() const { return store->getTestFullName(id); }
 
-};
+/*! \brief Retrieves the id of the test in its store.
+ */
+inline int GTest::getId() const { return id; }
 
-Q_DECLARE_METATYPE(GTest*);
+/*! \brief Retrieves the name of the test (without its suite).
+ */
+inline QString GTest::getName() const { return store->getTestName(id); }
 
-/*! \brief Called to run the unit test
- *
- * Currently this function simply emits a signal which is slotted to the
- * owning GTestSuite, which then emits another signal with its name,
- * so as to have the entirety of the test case and test name needed for
- * running.
- * TODO::We're planning on allowing a user to right click on a test and select
- * 	     run. In which case, this will not simply add the test to the queue,
- *       but may need some mechanism to run immediately. This is still in planning.
+/*! \brief Retrieves the result status of the last run of the test.
  */
-inline void GTest::run() { emit requestingRun(objectName()); }
+inline TestStore::STATUS GTest::getStatus() const { return store->getTestStatus(id); }
 
-/*! \brief Retrieve the results of the test.
+/*! \brief Whether this refers to a test that is in the listing.
  *
- * The pointer will be null if the test hasn't been run yet.
- * \return the pointer to the test results object
+ * The other accessors should only be called on valid tests.
  */
-inline GTestResults *GTest::getTestResults() const { return testResults; }
+inline bool GTest::isValid() const { return store && store->getTestRow(id) >= 0; }
 
 #endif /* GTEST_H_ */
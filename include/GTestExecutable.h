@@ -17,27 +17,40 @@
 #ifndef GTESTEXECUTABLE_H_
 #define GTESTEXECUTABLE_H_
 
-#include <QBuffer>
+#include <QElapsedTimer>
 #include <QObject>
 #include <QProcess>
 #include <QMetaType>
-#include <QMutex>
-#include <QSet>
+#include <QVector>
 
 #include "GTestExecutableResults.h"
 #include "GTestSuite.h"
+#include "ListingCache.h"
+#include "LogSource.h"
+#include "TestEngine.h"
+#include "TestStore.h"
+
+class GTestFilter;
+class TestHistory;
+class TestScheduler;
 
 /*! \brief This class logically represens a gtest executable file.
  *
  * This class attempts to mirror what an actual gtest executable is comprised of.
  * For example, it contains a name (filepath) and contains a collection
- * of unit test suites. Thus, this structure is reflected in objects of this
- * type hold a number of GTestSuites which hold the actual GTests.
+ * of unit test suites. The suites and tests are held in a compact TestStore
+ * rather than as objects of their own, so that executables with a very large
+ * number of tests stay cheap. GTestSuite and GTest are views over the store,
+ * and signals are only raised by the executable itself.
+ * The processes themselves are run by a TestEngine on a thread of its own,
+ * which hands back the parsed listings, test progress and results.
+ * Listings and runs are queued as jobs which the executable works on one at
+ * a time, each starting when the previous one has finished.
  * \note This file may separate into two or more classes to separate the
  * 		 process functionality from the logic. However, as it stands now,
  *       I think this is acceptable (for the current size).
  */
-class GTestExecutable : public GTestSuite {
+class GTestExecutable : public QObject {
 
 Q_OBJECT
 
@@ -54,18 +67,70 @@ public:
 										 *   insufficient privileges to view it */
 	};
 
+	/*! The kinds of job that can be queued on the executable.
+	 */
+	enum JOB {
+		LIST = 0,	//!< Produce a listing of the tests.
+		RUN,		//!< Run the tests checked in the store.
+		RERUN		//!< Run the tests that failed in the last run.
+	};
+
 private:
+
+	/*! \brief A job waiting for the executable.
+	 */
+	struct QueuedJob {
+		int id;		//!< The id returned when the job was queued.
+		JOB type;	//!< What the job does.
+	};
+
+	/*! \brief Where a test's console output is in the standard output of its shard.
+	 */
+	struct OutputRange {
+		int shard;		//!< The shard that ran the test, or -1 if its output hasn't been found.
+		qint64 start;	//!< The offset of the test's "[ RUN      ]" line.
+		qint64 end;		//!< The offset just past the test's last line of output.
+	};
+
 	STATE state;			//!< The state of the executable defined by 'name'
-	QMutex processLock;		//!< A lock to ensure only a single process is active
-	QMutex outputLock;		/*!< A lock to ensure that the output buffers only
-							 *   have a single writer. */
-	QProcess *gtest;		//!< The process thread for running tests.
-	QBuffer standardOutput;	//!< The buffer to hold the stdout text.
-	QBuffer standardError;	//!< The buffer to hold the stderr text.
-	QSet<QString> listingSet;//!< The set of unit test suites provided.
-	QSet<QString> oldListingSet;//!< The set of elements prior to an update.
-	QStringList testFilter; /*! A list of tests to add to the test filter command line
-							 * arguments. */
+	QList<QueuedJob> jobQueue; //!< The jobs that haven't been started yet, in order.
+	int currentJob;			//!< The id of the job being worked on, or 0 when idle.
+	bool startPending;		//!< Whether a startNextJob() has been queued on the event loop.
+	QStringList runSelection;	//!< The tests of the current run, in listing order.
+	static int nextJobId;	//!< The id given to the next queued job.
+	TestEngine* engine;		//!< The engine that runs the processes and parses their output.
+	int listingJob;			//!< The engine job producing the current listing, or 0.
+	QHash<int, int> shardJobs; //!< The shard index of each running engine job of the current run.
+	int resultsJob;			//!< The engine job parsing the results of the current run, or 0.
+	QStringList shardOutputPaths; //!< The result file written by each shard.
+	QString filterArgument;	//!< The --gtest_filter argument of the current run, empty to run all tests.
+	TestScheduler* scheduler;//!< The scheduler that launches the shards, or null to launch them all at once.
+	int shardCount;			//!< The maximum number of shards a test run is split into.
+	bool jsonResults;		//!< Whether the shards write their results as .json rather than .xml.
+	int runShardCount;		//!< The number of shards the current run is split into.
+	TestHistory* history;	//!< The durations of previous runs, or null if not kept.
+	int runningShards;		//!< The number of shards that haven't finished yet.
+	QProcess::ExitStatus shardExitStatus; //!< The worst exit status of the current shards.
+	int shardExitCode;		//!< The first non-zero exit code of the current shards.
+	QStringList shardFilters;	/*!< The --gtest_filter argument of each shard when the run is
+								 *   partitioned by duration. Empty when gtest's own
+								 *   round-robin sharding is used. */
+	QList<double> shardEstimates;	//!< The estimated running time of each shard.
+	QList<double> shardDurations;	//!< The measured running time of each shard.
+	QElapsedTimer runTimer;			//!< Measures the running time of the shards.
+	double predictedMakespan;		//!< The estimated running time of the longest shard of the last run.
+	double actualMakespan;			//!< The measured running time of the longest shard of the last run.
+	QList<OutputCapturePointer> standardOutputs;	//!< The stdout text of each shard of the last run.
+	QList<OutputCapturePointer> standardErrors;		//!< The stderr text of each shard of the last run.
+	QVector<OutputRange> testOutputs;	//!< The console output of each test of the last run, by test id.
+	TestStore store;		//!< The suites and tests of the listing.
+	GTestExecutableResults* testResults; //!< The results of the last run, built as it runs, or null.
+	QList<GTestExecutableResults*> previousResults; //!< The results of the runs before the last, most recent first.
+	int keptRuns;			//!< The number of runs before the last whose results are kept for comparison.
+	ListingCache* listingCache;	//!< The cache of listings, or null to always list the executable.
+	ExecutableIdentity listingIdentity; //!< The build of the executable the current listing is from.
+	ExecutableIdentity pendingIdentity; //!< The build of the executable being listed.
+	bool storeListing;			//!< Whether the listing being parsed should be stored in the cache.
 
 	QProcess::ProcessError error;	//!< The state of the QProcess after its run
 	QProcess::ExitStatus exitStatus;//!< The exit status of the QProcess
@@ -74,22 +139,42 @@ private:
     QString m_OutputFilePath;
 
 	void runExecutable(QStringList args);
-	void readExecutableOutput(QBuffer& standardChannel);
+	int enqueue(JOB type);
+	QList<double> estimateShards() const;
+	QStringList failedTests() const;
+	void finishJob();
+	void finishedTesting(int exitCode, QProcess::ExitStatus exitStatus);
+	GTestFilter listingFilter() const;
+	GTestResults* liveResults(int test, GTestSuiteResults** suiteResults);
+	void partitionShards();
+	QStringList orderedRunTests() const;
+	void receiveTestResults(GTestExecutableResults* testResults);
+	void scheduleNextJob();
+	QStringList selectedTests() const;
+	void startListing();
+	void startRun(const QStringList& selected);
+	void updateLiveResults(int test, const TestEvent& event);
+
+private slots:
+	void listingFinished(int job, int exitCode, int exitStatus, int error, TestListing listing, QByteArray output);
+	void processFinished(int job, int exitCode, int exitStatus, int error);
+	void resultsParsed(int job, GTestExecutableResults* results);
+	void startNextJob();
+	void testEvents(int job, QList<TestEvent> events);
 
 signals:
 	void listingReady(GTestExecutable* sender); //!< Sends notification that a new listing has been received.
-    void BeginTest(GTest*);
-    void EndTest(GTest*, bool success);
+	void shardFinished(); //!< Sends notification that a shard launched by launchShard() has exited.
+	void testsFinished(GTestExecutable* sender); //!< Sends notification that a run has finished and the test statuses are up to date.
+    void BeginTest(GTestExecutable* sender, int test);
+    void EndTest(GTestExecutable* sender, int test, bool success);
+	void jobCancelled(GTestExecutable* sender, int job); //!< Sends notification that a queued job was dropped before it started.
+	void jobFinished(GTestExecutable* sender, int job); //!< Sends notification that a queued job has finished.
 
 public slots:
-    void finishedListing(int exitCode, QProcess::ExitStatus exitStatus);
-    void finishedTesting(int exitCode, QProcess::ExitStatus exitStatus);
-    void parseListing(int exitCode, QProcess::ExitStatus exitStatus);
-    void resetRunState();
-	void runTest();
-	void standardErrorAvailable();
-	void standardOutputAvailable();
-	void receiveRunRequest(QString testName, QString testCase = QString());
+	int produceListing();
+	int rerunFailedTests();
+	int runTest();
 
 public:
 	GTestExecutable(QObject* parent = 0, QString executablePath = QString());
@@ -99,35 +184,53 @@ public:
 	QString getExecutablePath() const;
 	int getExitCode() const;
 	QProcess::ExitStatus getExitStatus() const;
-	const QSet<QString>& getListing() const;
-	const QSet<QString>& getOldListing() const;
+	double getActualMakespan() const;
+	double getPredictedMakespan() const;
+	int getRunShardCount() const;
+	int getShardCount() const;
+	QList<OutputCapturePointer> getStandardError() const;
+	QList<OutputCapturePointer> getStandardOutput() const;
+	TestStore& getStore();
+	GTestSuite getSuite(int row) const;
+	GTestSuite getSuite(const QString& suiteName) const;
+	int getSuiteCount() const;
+	GTest getTest(const QString& testName) const;
+	GTestExecutableResults* getTestResults() const;
+	GTestSuiteResults* getTestResults(const GTestSuite& suite) const;
+	GTestResults* getTestResults(const GTest& test) const;
+	GTestExecutableResults* getPreviousResults(int age = 1) const;
+	GTestResults* getPreviousResults(const GTest& test, int age = 1) const;
+	int getKeptRuns() const;
+	LogSourcePointer getTestOutput(const GTest& test) const;
 	STATE getState();
 
 	void setExecutablePath(QString executablePath);
     void setResultPath(QString resultPath){m_ResultsPath = resultPath;}
-    void setUpExecutable();
-    void cleanupExecutable(int exitCode, QProcess::ExitStatus exitStatus);
+	void setShardCount(int shardCount);
+	void setJsonResults(bool jsonResults);
+	void setKeptRuns(int keptRuns);
+	void setScheduler(TestScheduler* scheduler);
+	void setHistory(TestHistory* history);
+	void setListingCache(ListingCache* listingCache);
+	void setEngine(TestEngine* engine);
 
-	void produceListing();
-	virtual void run();
-    void Kill(){ gtest->kill(); }
+	bool cancel(int job);
+	bool isBalancedRun() const;
+	bool isBusy() const;
+	void launchShard(int shardIndex);
+    void Kill();
 };
 
 Q_DECLARE_METATYPE(GTestExecutable*);
 
-/*! \brief Retrieves the listing (not necessarily populated).
+/*! \brief Retrieves the store holding the listing (not necessarily populated).
  *
  * The caller should ensure that produceListing() has been called first and
- * that the QProcess has successfully completed.
+ * that the QProcess has successfully completed. The check states in the
+ * store select the tests run by runTest().
  * \see GTestExecutable::produceListing()
  */
-inline const QSet<QString>& GTestExecutable::getListing() const { return listingSet; }
-
-/*! \brief Retrieves the listing prior to an update (not necessarily populated).
- *
- * If nothing has changed between sets, oldListing should be equal to listing.
- */
-inline const QSet<QString>& GTestExecutable::getOldListing() const { return oldListingSet; }
+inline TestStore& GTestExecutable::getStore() { return store; }
 
 /*! \brief Retrieves the executable path (i.e. name) of the executable file
  *
@@ -160,6 +263,132 @@ inline QProcess::ExitStatus GTestExecutable::getExitStatus() const { return exit
  */
 inline int GTestExecutable::getExitCode() const { return exitCode; }
 
+/*! \brief Retrieves whether a job is being worked on or waiting to be.
+ */
+inline bool GTestExecutable::isBusy() const { return currentJob != 0 || !jobQueue.isEmpty(); }
+
+/*! \brief Retrieves the measured running time of the longest shard of the last run.
+ *
+ * \return The running time in seconds.
+ */
+inline double GTestExecutable::getActualMakespan() const { return actualMakespan; }
+
+/*! \brief Retrieves the estimated running time of the longest shard of the last run.
+ *
+ * \return The estimate in seconds.
+ * \see TestHistory::estimate()
+ */
+inline double GTestExecutable::getPredictedMakespan() const { return predictedMakespan; }
+
+/*! \brief Retrieves the suite in row 'row' of the listing.
+ *
+ * \return The suite, which is invalid if the row is out of range.
+ */
+inline GTestSuite GTestExecutable::getSuite(int row) const { return GTestSuite(&store, store.getSuite(row)); }
+
+/*! \brief Retrieves a suite of this executable by name.
+ *
+ * This is a constant time lookup in the index maintained by the store.
+ * \param suiteName The name of the suite.
+ * \return The suite, which is invalid if the listing has no such suite.
+ */
+inline GTestSuite GTestExecutable::getSuite(const QString& suiteName) const { return GTestSuite(&store, store.findSuite(suiteName)); }
+
+/*! \brief Retrieves the number of suites in the listing.
+ */
+inline int GTestExecutable::getSuiteCount() const { return store.getSuiteCount(); }
+
+/*! \brief Retrieves a test of this executable by its full name.
+ *
+ * This is a constant time lookup in the index maintained by the store.
+ * \param testName The name of the test in the form "suitename.testname".
+ * \return The test, which is invalid if the listing has no such test.
+ */
+inline GTest GTestExecutable::getTest(const QString& testName) const { return GTest(&store, store.findTest(testName)); }
+
+/*! \brief Retrieves the results of the last run.
+ *
+ * \return The results, or null if the executable hasn't produced any yet.
+ */
+inline GTestExecutableResults* GTestExecutable::getTestResults() const { return testResults; }
+
+/*! \brief Retrieves the results of a run before the last.
+ *
+ * \param age How many runs before the last, 1 being the run before it.
+ * \return The results, or null if that run's results weren't kept.
+ */
+inline GTestExecutableResults* GTestExecutable::getPreviousResults(int age) const { return previousResults.value(age - 1, 0); }
+
+/*! \brief Retrieves the number of runs before the last whose results are kept.
+ *
+ */
+inline int GTestExecutable::getKeptRuns() const { return keptRuns; }
+
+/*! \brief Retrieves the number of shards the last run was split into.
+ */
+inline int GTestExecutable::getRunShardCount() const { return runShardCount; }
+
+/*! \brief Whether the shards of the last run were balanced by duration.
+ *
+ * Otherwise gtest split the tests round-robin.
+ */
+inline bool GTestExecutable::isBalancedRun() const { return !shardFilters.isEmpty(); }
+
+/*! \brief Retrieves the number of shards a test run is split into.
+ *
+ * Each shard is a separate process of the same executable which runs
+ * its share of the tests through gtest's GTEST_TOTAL_SHARDS and
+ * GTEST_SHARD_INDEX environment variables.
+ */
+inline int GTestExecutable::getShardCount() const { return shardCount; }
+
+/*! \brief Retrieves the captured standard output of each shard of the last run.
+ *
+ * The captures are filled while the run is in progress.
+ */
+inline QList<OutputCapturePointer> GTestExecutable::getStandardOutput() const { return standardOutputs; }
+
+/*! \brief Retrieves the captured standard error of each shard of the last run.
+ *
+ * The captures are filled while the run is in progress.
+ */
+inline QList<OutputCapturePointer> GTestExecutable::getStandardError() const { return standardErrors; }
+
+/*! \brief Sets the number of shards a test run is split into.
+ *
+ * A value of 1 runs the executable as a single unsharded process.
+ * \param shardCount The number of processes to run, values below 1 are clamped to 1.
+ */
+inline void GTestExecutable::setShardCount(int shardCount) { this->shardCount = qMax(1, shardCount); }
+
+/*! \brief Sets whether the shards write their results as .json rather than .xml.
+ *
+ * gtest writes .json results from version 1.8.1. They are parsed by the
+ * GTestJsonParser, which reads them faster and in less memory.
+ */
+inline void GTestExecutable::setJsonResults(bool jsonResults) { this->jsonResults = jsonResults; }
+
+/*! \brief Sets the scheduler used to launch the shards of a test run.
+ *
+ * When a scheduler is set, runTest() only queues the shards and the
+ * scheduler decides when each one is started. Without one, every shard
+ * is started as soon as the run is requested.
+ * \param scheduler The scheduler to queue shards on, or null.
+ */
+inline void GTestExecutable::setScheduler(TestScheduler* scheduler) { this->scheduler = scheduler; }
+
+/*! \brief Sets the history used to estimate and record test durations.
+ *
+ * \param history The history to use, or null to treat every test as equal.
+ */
+inline void GTestExecutable::setHistory(TestHistory* history) { this->history = history; }
+
+/*! \brief Sets the cache that listings are looked up in and stored to.
+ *
+ * \param listingCache The cache to use, or null to always run --gtest_list_tests.
+ */
+inline void GTestExecutable::setListingCache(ListingCache* listingCache) { this->listingCache = listingCache; }
+
 /*! \brief Sets the executable's path.
  *
  * This will set the executables path. One can check to see if the path is
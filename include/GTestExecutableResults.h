@@ -19,23 +19,39 @@
 
 
 #include <QHash>
+#include <QList>
 #include <QString>
 
 #include "Defines.h"
 #include "GTestSuiteResults.h"
+#include "ResultArena.h"
 
-/*! \brief Placeholder class to differentiate from GTestSuiteResults.
+/*! \brief The root of a tree of results, which owns the whole tree.
  *
- * Currently, this class provides no functionality beyond that of a
- * GTestSuiteResults object. However, further changes to the software
- * may prompt usefulness from this class.
+ * The suites and tests of the tree are created in the tree's ResultArena
+ * with createSuiteResults() and createTestResults(), so deleting the root
+ * releases the whole tree at once. A tree merged into another hands its
+ * arenas over with its results, while a tree reconciled into another is
+ * released once the results it adds have been copied.
  */
 class GTestExecutableResults : public GTestSuiteResults {
 
+private:
+	QList<ResultArena*> arenas;	//!< The arenas of the results in the tree, its own first.
+
+	void adoptArenas(GTestExecutableResults* other);
+	GTestResults* copyResults(const GTestResults* results);
+	void reconcileSuite(GTestSuiteResults* suite, const GTestSuiteResults* other);
+
 public:
     GTestExecutableResults();
 	virtual ~GTestExecutableResults();
 
+	GTestSuiteResults* createSuiteResults();
+	GTestResults* createTestResults();
+	void merge(GTestExecutableResults* other);
+	void reconcile(GTestExecutableResults* other);
+
 };
 
 #endif /* GTESTEXECUTABLERESULTS_H_ */
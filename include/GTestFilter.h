@@ -0,0 +1,61 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * GTestFilter.h - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GTESTFILTER_H_
+#define GTESTFILTER_H_
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+/*! \brief Compiles a selection of tests into a compact --gtest_filter pattern.
+ *
+ * Naming every selected test in the filter produces an argument that grows
+ * with the number of tests, which can exceed the system's argument length
+ * limit and makes gtest match every test against every pattern. Given the
+ * full listing of an executable, this class instead collapses the selection:
+ * \li If every test is selected, the filter is empty and no filter is needed.
+ * \li A suite with all of its tests selected becomes "suite.*".
+ * \li If naming the unselected tests is shorter, the negative form
+ *     "*-suite.test:other.*" is used instead.
+ */
+class GTestFilter {
+
+private:
+	QStringList suites;						//!< The suites of the listing, in order.
+	QHash<QString, QStringList> suiteTests;	//!< Maps each suite to its tests, in order.
+	QHash<QString, QSet<QString> > suiteTestSets; //!< Maps each suite to its tests, for lookups.
+	int testCount;							//!< The total number of tests in the listing.
+
+	QString compilePositive(const QHash<QString, QSet<QString> >& selectedTests) const;
+	QString compileNegative(const QHash<QString, QSet<QString> >& selectedTests) const;
+
+public:
+	GTestFilter();
+	~GTestFilter();
+
+	void addSuite(const QString& suite, const QStringList& tests);
+	QString compile(const QStringList& selected, bool allowNegative = true) const;
+	int getTestCount() const;
+};
+
+/*! \brief Retrieves the total number of tests in the listing.
+ */
+inline int GTestFilter::getTestCount() const { return testCount; }
+
+#endif /* GTESTFILTER_H_ */
@@ -0,0 +1,57 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * GTestJsonParser.h - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GTESTJSONPARSER_H_
+#define GTESTJSONPARSER_H_
+
+#include <QIODevice>
+
+#include "GTestExecutableResults.h"
+
+/*! \brief This class parses a .json file outputted by a gtest executable.
+ *
+ * gtest writes its results as JSON when run with --gtest_output=json:<path>.
+ * The file holds the same tree as the .xml file, which this parser reads
+ * into the same tree of GTestResults objects as the GTestParser does. The
+ * values are given as the .xml file gives them, so that the rest of the
+ * runner doesn't need to know which file the results came from.
+ * The file is read with a JsonStreamReader, so it is parsed in constant
+ * memory apart from the results themselves.
+ */
+class GTestJsonParser {
+
+private:
+	/*! \brief The objects and arrays of a gtest .json file.
+	 */
+	enum FRAME {
+		EXECUTABLE = 0,	//!< The object of the whole run.
+		SUITES,			//!< The array of the run's suites.
+		SUITE,			//!< The object of a suite.
+		TESTS,			//!< The array of a suite's tests.
+		TEST,			//!< The object of a test.
+		FAILURES,		//!< The array of a test's failures.
+		FAILURE,		//!< The object of a failure.
+		OTHER			//!< An object or array that isn't read.
+	};
+
+	QIODevice *jsonSource;	//!< A pointer to the gtest .json source
+
+public:
+	GTestJsonParser(QIODevice *inStream);
+	GTestExecutableResults* parse();
+};
+
+#endif /* GTESTJSONPARSER_H_ */
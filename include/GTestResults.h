@@ -17,8 +17,11 @@
 #ifndef GTESTRESULTS_H_
 #define GTESTRESULTS_H_
 
+#include <QHash>
+#include <QReadWriteLock>
 #include <QSharedPointer>
 #include <QStringList>
+#include <QVector>
 
 /* \brief This class logically represents the results of running a unit test.
  *
@@ -27,39 +30,107 @@
  * time of the test, any failure messages that were produced and a summary result
  * status (pass/fail). In the subclasses, these variables also apply, but differ
  * in that a GTestSuiteResults comprises the results of all tests within the suite.
+ *
+ * A run may have a million tests, so the attributes gtest gives every test
+ * are kept in a compact typed record rather than a hash of strings: the
+ * time, timestamp and line as numbers, the status as a STATUS and the
+ * strings, which mostly repeat from test to test and run to run, as ids
+ * interned in a table shared by all results. The timestamp is not
+ * interned, as gtest gives every test a different one and the table is
+ * never freed. Any other attribute, such as the counters of a suite, is
+ * kept as a string in a side table. Every attribute can still be read as
+ * a string with get().
  */
 class GTestResults {
 
+public:
+	/*! \brief The status gtest gives a test.
+	 */
+	enum STATUS {
+		NO_STATUS = 0,	//!< The status isn't known.
+		RUN,			//!< The test was run ("run").
+		NOTRUN			//!< The test wasn't run, e.g. as it is disabled ("notrun").
+	};
+
+private:
+	/*! \brief The string attributes that are interned.
+	 */
+	enum STRING_ATTRIBUTE {
+		NAME = 0,
+		CLASSNAME,
+		RESULT,
+		FILE,
+		STRING_ATTRIBUTE_COUNT
+	};
+
+	/*! \brief How the timestamp attribute was written, so that it reads back the same.
+	 */
+	enum TIMESTAMP_FORMAT {
+		NO_TIMESTAMP = 0,				//!< The timestamp wasn't given.
+		TIMESTAMP_GIVEN = 1,			//!< The timestamp was given as "yyyy-MM-ddTHH:mm:ss".
+		TIMESTAMP_MILLISECONDS = 2,		//!< The timestamp has a ".zzz" fraction.
+		TIMESTAMP_UTC = 4				//!< The timestamp has a "Z" suffix.
+	};
+
+	static const char* const stringAttributeNames[STRING_ATTRIBUTE_COUNT]; //!< The names of the interned attributes.
+	static QReadWriteLock internLock;		//!< Guards the interned strings, which every thread adds to.
+	static QVector<QString> internedStrings;//!< The interned strings, by id.
+	static QHash<QString, int> internedIds;	//!< Maps each interned string to its id.
+
+	qint32 strings[STRING_ATTRIBUTE_COUNT];	//!< The id of each interned attribute, or -1 if not given.
+	qint32 line;							//!< The line attribute, or -1 if not given.
+	double time;							//!< The time attribute in seconds, or -1 if not given.
+	qint64 timestamp;						//!< The timestamp attribute in milliseconds since the epoch, its fields read as UTC.
+	quint8 timestampFormat;					//!< The TIMESTAMP_FORMAT flags of the timestamp attribute.
+	quint8 status;							//!< The STATUS given by the status attribute.
+
+	static int intern(const QString& string);
+	static QString internedString(int id);
+	static bool parseTimestamp(const QString& value, qint64* milliseconds, quint8* format);
+	static QString formatTimestamp(qint64 milliseconds, quint8 format);
+
 protected:
 	QStringList failureMessages;	//!< The list of failure messages --unparsed.
-    QHash<QString, QString> attributes;
+	QVector<int> failureLineCounts;	//!< The number of lines of each failure message.
+	QHash<QString, QString> otherAttributes; //!< The attributes without a field of their own.
 
 public:
     GTestResults();
 	virtual ~GTestResults();
 
 	void addFailureMessage(QString failureMsg);
-    void addAttribute(QString name, QString value) {attributes.insert(name, value);}
-    QString serialiseAttributes();
+    void addAttribute(QString name, QString value);
+	void enrich(const GTestResults& other);
+    QString serialiseAttributes() const;
 
-    QString get(QString iname){ return attributes.value(iname);}
+    QString get(QString iname) const;
+	QString getName() const;
+	STATUS getStatus() const;
+	double getTime() const;
+	void setTime(double seconds);
 
     virtual uint getFailureCount() const;
 	QString getFailureMessage(uint index) const;
+	int getFailureLineCount(uint index) const;
 	QStringList getFailureMessages() const;
 
 	virtual GTestResults* getTestResults(QString name);
 
 };
 
-/*! \brief Adds a failure message to the list of failure messages.
+/*! \brief Retrieves the name attribute of the test (or suite).
+ */
+inline QString GTestResults::getName() const { return internedString(strings[NAME]); }
+
+/*! \brief Retrieves the status attribute of the test.
+ */
+inline GTestResults::STATUS GTestResults::getStatus() const { return (STATUS)status; }
+
+/*! \brief Retrieves the time attribute of the test (or suite).
  *
- * This appends a failure message to the end of the list of failure messages.
- * \param failureMsg The failure message as retrieved from the gtest executable.
+ * \return The running time in seconds, or -1 if it isn't known.
  */
-inline void GTestResults::addFailureMessage(QString failureMsg) {
-	failureMessages.append(failureMsg);
-}
+inline double GTestResults::getTime() const { return time; }
 
 /*! \brief Retrieves the total number of failure messages for this test.
  *
@@ -83,6 +154,15 @@ inline QString GTestResults::getFailureMessage(uint index) const {
 	return failureMessages.at(index);
 }
 
+/*! \brief Retrieves the number of lines of the failure message indexed by 'index'.
+ *
+ * The lines are counted as the message is added, so that the message can
+ * be shown without scanning it again. An unterminated last line counts.
+ */
+inline int GTestResults::getFailureLineCount(uint index) const {
+	return failureLineCounts.at(index);
+}
+
 /*! \brief Retrieves the entire list of failure messages.
  *
  * If you wish to iterate through all messages, this function is the
@@ -99,6 +179,6 @@ inline QStringList GTestResults::getFailureMessages() const {
  * to other test results.
  * \return A pointer to a GTestResult.
  */
-inline GTestResults* GTestResults::getTestResults(QString name) { return (name == attributes.value("name") ? this : 0); }
+inline GTestResults* GTestResults::getTestResults(QString name) { return (name == getName() ? this : 0); }
 
 #endif /* GTESTRESULTS_H_ */
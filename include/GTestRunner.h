@@ -51,6 +51,11 @@ public:
     ~GTestRunner();
     void AddExecutable(QString filepath);
     void AddResultsPath(QString outputDir){ m_resultspath = outputDir;}
+    void SetShardCount(int shardCount);
+    void SetJsonResults(bool jsonResults);
+    void SetKeptRuns(int keptRuns);
+    void SetMaxProcesses(int maxProcesses);
+    void SetHashListings(bool hashListings);
 signals:
 	void runningTests();	//!< Sends a signal when the processes have been launched.
 
@@ -59,6 +64,8 @@ public slots:
 	void treeItemClicked(QTreeWidgetItem* item, int column);
     void DisableRunAction();
     void EnableRunAction();
+    void findAgain();
+    void showSearchResult(bool found);
 
 private:
 	void setup();
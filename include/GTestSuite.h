@@ -17,67 +17,71 @@
 #ifndef GTESTFIXTURE_H_
 #define GTESTFIXTURE_H_
 
-#include <QList>
-#include <QMetaType>
-#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <qnamespace.h>
 
 #include "GTest.h"
-#include "GTestSuiteResults.h"
+#include "TestStore.h"
 
 /*! \brief This class logically represents a suite of unit tests.
  *
  * This class attempts to mirror what an actual unit test suite is comprised of.
  * For example, it extends the concept of a unit test in that it has both a name and a result.
  * However, it differs in that a suite holds a collection of individual unit tests.
- * Thus, this structure is reflected in objects of this type are hold GTests
- * and is held by a GTestExecutable object.
+ * Like GTest, it is a lightweight view of a suite held in the TestStore of its
+ * GTestExecutable. Its check state and status are aggregated from its tests.
+ * \see TestStore
  */
-class GTestSuite : public GTest {
-
-Q_OBJECT
+class GTestSuite {
 
 protected:
-	QList<GTest*> runList; /*! The list of GTests that have requested to be run.
-							*  This list is maintained so as to increase the efficiency
-							*  with which test result objects can be disseminated.
-							*/
-
-public slots:
-	virtual void receiveRunRequest(QString testName, QString testCase = QString());
+	const TestStore* store;	//!< The store holding the suite.
+	int id;					//!< The id of the suite in the store.
 
 public:
-    GTestSuite(QObject* parent, QString name = QString());
-    GTestSuite(GTestSuite* parent, QString name = QString());
-	virtual ~GTestSuite();
-	void addTest(GTest* test);
-	void removeTest(GTest* test);
-	virtual void receiveTestResults(GTestResults* testSuiteResults);
+	GTestSuite(const TestStore* store = 0, int id = -1);
 
-	virtual void run();
+	Qt::CheckState getCheckState() const;
+	int getId() const;
+	QString getName() const;
+	TestStore::STATUS getStatus() const;
+	GTest getTest(int row) const;
+	int getTestCount() const;
+	QStringList getTestNames() const;
+	bool isValid() const;
 };
 
-Q_DECLARE_METATYPE(GTestSuite*);
+/*! \brief Retrieves the aggregate check state of the suite's tests.
+ */
+inline Qt::CheckState GTestSuite::getCheckState() const { return store->getSuiteCheckState(id); }
+
+/*! \brief Retrieves the id of the suite in its store.
+ */
+inline int GTestSuite::getId() const { return id; }
 
-/*! \brief Adds a test to the suite of tests.
- *
- * This method sets up the signal/slot relation between this GTestSuite
- * and the added GTest. Thus, when a GTest requests to be run through a signal,
- * this GTestSuite can received the signal, add the GTest to its run list, and
- * propagate the signal to the GTestExecutable for running.
+/*! \brief Retrieves the name of the suite.
  */
-inline void GTestSuite::addTest(GTest* test) {
-	QObject::connect(test, SIGNAL(requestingRun(QString, QString)),
-					 this, SLOT(receiveRunRequest(QString, QString)));
-}
+inline QString GTestSuite::getName() const { return store->getSuiteName(id); }
 
-/*! \brief Removes a test from the GTestSuite object.
+/*! \brief Retrieves the aggregate result status of the suite's tests.
+ */
+inline TestStore::STATUS GTestSuite::getStatus() const { return store->getSuiteStatus(id); }
+
+/*! \brief Retrieves the test in row 'row' of the suite.
  *
- * This dismantles the signal/slot relation set up in addTest.
+ * \return The test, which is invalid if the row is out of range.
+ */
+inline GTest GTestSuite::getTest(int row) const { return GTest(store, store->getTest(id, row)); }
+
+/*! \brief Retrieves the number of tests in the suite.
  */
-inline void GTestSuite::removeTest(GTest* test) {
-	QObject::disconnect(test, SIGNAL(requestingRun(QString, QString)),
-					 this, SLOT(receiveRunRequest(QString, QString)));
-}
+inline int GTestSuite::getTestCount() const { return store->getTestCount(id); }
 
+/*! \brief Whether this refers to a suite that is in the listing.
+ *
+ * The other accessors should only be called on valid suites.
+ */
+inline bool GTestSuite::isValid() const { return store && store->getSuiteRow(id) >= 0; }
 
 #endif /* GTESTFIXTURE_H_ */
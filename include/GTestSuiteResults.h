@@ -38,8 +38,10 @@ public:
 	virtual ~GTestSuiteResults();
 
     void addTestResults(GTestResults* testResults);
+    void merge(GTestSuiteResults* other);
 
     GTestResults* getTestResults(QString testName);
+    QList<GTestResults*> getTestResultsList() const;
 };
 
 /*! \brief Adds the test result as a child of this test result.
@@ -48,7 +50,7 @@ public:
  * \param testResults The results of a single unit test.
  */
 inline void GTestSuiteResults::addTestResults(GTestResults* testResults) {
-    testResultsHash.insert(testResults->get("name"), testResults);
+    testResultsHash.insert(testResults->getName(), testResults);
 }
 
 /*! \brief Retrieves the test results given by the test named 'testName'.
@@ -62,4 +64,12 @@ inline GTestResults* GTestSuiteResults::getTestResults(QString testName) {
 	return testResultsHash.value(testName);
 }
 
+/*! \brief Retrieves the results of every test held by this object.
+ *
+ * \return A list of the child results, in no particular order.
+ */
+inline QList<GTestResults*> GTestSuiteResults::getTestResultsList() const {
+	return testResultsHash.values();
+}
+
 #endif /* GTESTSUITERESULTS_H_ */
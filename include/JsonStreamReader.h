@@ -0,0 +1,96 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * JsonStreamReader.h - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef JSONSTREAMREADER_H_
+#define JSONSTREAMREADER_H_
+
+#include <QByteArray>
+
+class QIODevice;
+
+/*! \brief A pull reader of JSON documents, in the manner of QXmlStreamReader.
+ *
+ * The document is read from its device a chunk at a time and handed out
+ * a token at a time, so that documents of any size are read in constant
+ * memory. The text of a name or value is kept in a buffer that is reused
+ * from one token to the next, so reading allocates next to nothing; it is
+ * up to the caller to convert what it needs.
+ * The reader only checks that objects and arrays are balanced and that
+ * strings are well formed. It is meant for documents written by programs
+ * such as gtest rather than as a validator, so separators aren't checked.
+ */
+class JsonStreamReader {
+
+public:
+	/*! \brief The kinds of token read.
+	 */
+	enum TOKEN {
+		NONE = 0,		//!< Nothing has been read yet.
+		BEGIN_OBJECT,	//!< The start of an object.
+		END_OBJECT,		//!< The end of an object.
+		BEGIN_ARRAY,	//!< The start of an array.
+		END_ARRAY,		//!< The end of an array.
+		NAME,			//!< The name of a member of an object, in getText().
+		STRING,			//!< A string value, in getText().
+		NUMBER,			//!< A number value, in getText() as it was written.
+		LITERAL,		//!< One of true, false and null, in getText().
+		END_DOCUMENT,	//!< The end of the document.
+		INVALID			//!< The document is malformed or couldn't be read.
+	};
+
+private:
+	static const int CHUNK_SIZE = 64 * 1024;	//!< The number of bytes read from the device at a time.
+
+	QIODevice* device;		//!< The device the document is read from.
+	QByteArray buffer;		//!< The chunk of the document being read.
+	int length;				//!< The number of bytes of the chunk in 'buffer'.
+	int position;			//!< The position in 'buffer' of the next byte to read.
+	QByteArray text;		//!< The text of the last name or value read, in UTF-8.
+	QByteArray containers;	//!< '{' or '[' for each object or array being read, innermost last.
+	TOKEN token;			//!< The last token read.
+
+	bool fill();
+	int next();
+	int peek();
+	bool readEscape();
+	bool readHex(uint* code);
+	bool readString();
+	TOKEN readScalar(int first);
+
+public:
+	JsonStreamReader(QIODevice* device);
+
+	int getDepth() const;
+	const QByteArray& getText() const;
+	TOKEN getToken() const;
+	TOKEN readNext();
+};
+
+/*! \brief Retrieves the number of objects and arrays that the last token is in.
+ */
+inline int JsonStreamReader::getDepth() const { return containers.size(); }
+
+/*! \brief Retrieves the text of the last name or value read.
+ *
+ * The text is only valid until the next token is read.
+ */
+inline const QByteArray& JsonStreamReader::getText() const { return text; }
+
+/*! \brief Retrieves the last token read.
+ */
+inline JsonStreamReader::TOKEN JsonStreamReader::getToken() const { return token; }
+
+#endif /* JSONSTREAMREADER_H_ */
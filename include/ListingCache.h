@@ -0,0 +1,91 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * ListingCache.h - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef LISTINGCACHE_H_
+#define LISTINGCACHE_H_
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+/*! \brief Identifies a particular build of an executable file.
+ *
+ * Two identities are considered equal if they have the same fingerprint
+ * (the ELF build-id, or a hash of the file's contents), or, when either has no
+ * fingerprint, the same size and modification time.
+ */
+struct ExecutableIdentity {
+	qint64 size;			//!< The size of the file in bytes, or -1 if unknown.
+	qint64 modified;		//!< The modification time in ms since the epoch.
+	QByteArray fingerprint;	//!< The ELF build-id or content hash, may be empty.
+
+	ExecutableIdentity();
+	bool isValid() const;
+	bool operator==(const ExecutableIdentity& other) const;
+	bool operator!=(const ExecutableIdentity& other) const;
+};
+
+/*! \brief A persistent cache of the --gtest_list_tests output of executables.
+ *
+ * Listing a gtest executable requires running it, which can take seconds for
+ * executables with heavy static initialisation. The cache stores the raw
+ * listing of each executable on disk along with the identity of the file
+ * it came from, so that an unchanged executable never has to be listed again.
+ */
+class ListingCache {
+
+private:
+	QString directory;	//!< The directory holding one cache file per executable.
+	bool hashContents;	//!< Whether to hash the contents of files that have no build-id.
+	mutable QHash<QString, ExecutableIdentity> hashedIdentities; //!< The identity last hashed of each executable, by absolute path.
+
+	QString cacheFilePath(const QString& executablePath) const;
+
+public:
+	ListingCache(QString directory = QString());
+	~ListingCache();
+
+	bool getHashContents() const;
+	ExecutableIdentity identify(const QString& executablePath) const;
+	bool lookup(const QString& executablePath, const ExecutableIdentity& identity, QByteArray* listing) const;
+	static QByteArray readBuildId(const QString& executablePath);
+	void setHashContents(bool hashContents);
+	bool store(const QString& executablePath, const ExecutableIdentity& identity, const QByteArray& listing) const;
+};
+
+/*! \brief Whether the identity was read from an existing file.
+ */
+inline bool ExecutableIdentity::isValid() const { return size >= 0; }
+
+/*! \brief Whether the two identities refer to different builds.
+ */
+inline bool ExecutableIdentity::operator!=(const ExecutableIdentity& other) const { return !(*this == other); }
+
+/*! \brief Whether the contents of files without a build-id are hashed.
+ */
+inline bool ListingCache::getHashContents() const { return hashContents; }
+
+/*! \brief Sets whether the contents of files without a build-id are hashed.
+ *
+ * Hashing lets an executable that was rebuilt or touched without changing be
+ * recognised, at the cost of reading the whole file when its size or
+ * modification time change.
+ * \param hashContents true to hash the contents, false to compare only the size
+ * 		  and modification time.
+ */
+inline void ListingCache::setHashContents(bool hashContents) { this->hashContents = hashContents; }
+
+#endif /* LISTINGCACHE_H_ */
@@ -0,0 +1,122 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * LogSource.h - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef LOGSOURCE_H_
+#define LOGSOURCE_H_
+
+#include <QByteArray>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+#include "OutputCapture.h"
+
+/*! \brief The lines of text shown by a LogView.
+ *
+ * A source hands out its lines a page at a time, so that a view only reads
+ * the lines it shows however many there are. Every line read is terminated
+ * by a newline, including an unterminated last line.
+ */
+class LogSource {
+
+public:
+	virtual ~LogSource();
+
+	virtual qint64 getLineCount() const = 0;
+	virtual QByteArray readLines(qint64 firstLine, int count) const = 0;
+};
+
+/*! \brief A source shared by the views showing it.
+ */
+typedef QSharedPointer<LogSource> LogSourcePointer;
+
+/*! \brief Lines of text held in memory.
+ */
+class TextLogSource : public LogSource {
+
+private:
+	QByteArray text;			//!< The text, ending with a newline unless it's empty.
+	QVector<int> lineOffsets;	//!< The offset of each line in 'text', followed by the size of 'text'.
+
+public:
+	TextLogSource(const QByteArray& text);
+
+	virtual qint64 getLineCount() const;
+	virtual QByteArray readLines(qint64 firstLine, int count) const;
+};
+
+/*! \brief The lines of a message, such as a test's failure message.
+ *
+ * The message is only encoded and indexed once its lines are first read,
+ * so a view can be given many long messages and only pay for those it
+ * shows. Its line count is counted up front unless the caller knows it.
+ */
+class MessageLogSource : public LogSource {
+
+private:
+	QString message;	//!< The message, shared with its owner.
+	qint64 lineCount;	//!< The number of lines of the message.
+	mutable QSharedPointer<TextLogSource> text;	//!< The encoded and indexed message, once it has been read.
+
+public:
+	MessageLogSource(const QString& message, qint64 lineCount = -1);
+
+	static qint64 countLines(const QString& message);
+
+	virtual qint64 getLineCount() const;
+	virtual QByteArray readLines(qint64 firstLine, int count) const;
+};
+
+/*! \brief The lines of a range of captured output.
+ *
+ * The lines are looked up through the capture's line index, so neither the
+ * range nor the capture is scanned as a whole.
+ */
+class CaptureLogSource : public LogSource {
+
+private:
+	OutputCapturePointer capture;	//!< The captured output.
+	qint64 start;					//!< The offset of the range in the capture.
+	qint64 end;						//!< The offset just past the range.
+	qint64 firstLine;				//!< The line of the capture that the range starts on.
+	qint64 lineCount;				//!< The number of lines in the range.
+
+public:
+	static const int MAX_READ = 4 * 1024 * 1024;	//!< The most bytes read at once, however long the lines are.
+
+	CaptureLogSource(OutputCapturePointer capture, qint64 start, qint64 end);
+
+	virtual qint64 getLineCount() const;
+	virtual QByteArray readLines(qint64 firstLine, int count) const;
+};
+
+/*! \brief The lines of several sources, one source after the other.
+ */
+class ConcatenatedLogSource : public LogSource {
+
+private:
+	QList<LogSourcePointer> sources;	//!< The sources, in order.
+	QVector<qint64> firstLines;			//!< The first line of each source, followed by the line count.
+
+public:
+	ConcatenatedLogSource(const QList<LogSourcePointer>& sources);
+
+	virtual qint64 getLineCount() const;
+	virtual QByteArray readLines(qint64 firstLine, int count) const;
+};
+
+#endif /* LOGSOURCE_H_ */
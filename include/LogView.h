@@ -0,0 +1,109 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * LogView.h - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef LOGVIEW_H_
+#define LOGVIEW_H_
+
+#include <QAbstractScrollArea>
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+#include "LogSource.h"
+
+class QTimer;
+
+/*! \brief A read-only view of a log of any size.
+ *
+ * Unlike a QPlainTextEdit, which lays out the whole of its text when it is
+ * set, the view only reads and draws the lines that are visible, paging
+ * them in from its LogSource as it is scrolled. Searching is incremental
+ * and runs in batches of lines on the event loop, so neither showing nor
+ * searching a log holds up the GUI however long the log is.
+ * Whole lines are selected with the mouse, or all of them with
+ * QKeySequence::SelectAll, and QKeySequence::Copy copies the selected
+ * lines, or the visible ones if none are selected.
+ */
+class LogView : public QAbstractScrollArea {
+
+	Q_OBJECT
+
+private:
+	LogSourcePointer source;	//!< The lines shown, or null.
+	qint64 lineCount;			//!< The number of lines of 'source'.
+	qint64 pageFirstLine;		//!< The line of 'source' that 'page' starts with.
+	QList<QByteArray> page;		//!< The lines last read from 'source', around the visible ones.
+	int longestLine;			//!< The width in pixels of the widest line drawn so far.
+	QByteArray searchPattern;	//!< The text searched for, in lower case, or empty if not searching.
+	bool searchForward;			//!< Whether the search runs towards the end of the log.
+	qint64 searchLine;			//!< The line the next batch of the search starts on.
+	qint64 searchedLines;		//!< The number of lines the search has been through.
+	qint64 matchLine;			//!< The line of the current match, or -1.
+	qint64 selectionAnchor;		//!< The line the selection was started on, or -1 if nothing is selected.
+	qint64 selectionEnd;		//!< The line the selection was extended to.
+	QTimer* searchTimer;		//!< Runs the batches of the search.
+
+	qint64 lineAt(int y) const;
+	QString lineText(qint64 line);
+	bool isSelected(qint64 line) const;
+	void readPage(qint64 firstLine, int count);
+	void showLine(qint64 line);
+	void startSearch(qint64 line, bool forward);
+	void updateScrollBars();
+	int visibleLineCount() const;
+
+private slots:
+	void searchStep();
+
+protected:
+	virtual void keyPressEvent(QKeyEvent* event);
+	virtual void mouseMoveEvent(QMouseEvent* event);
+	virtual void mousePressEvent(QMouseEvent* event);
+	virtual void paintEvent(QPaintEvent* event);
+	virtual void resizeEvent(QResizeEvent* event);
+
+signals:
+	void searchFinished(bool found);	//!< Sends a signal when a search has found a match or run out of lines.
+
+public:
+	static const int SEARCH_BATCH = 8192;		//!< The number of lines searched at a time.
+	static const int MAX_LINE_LENGTH = 4096;	//!< The most characters drawn of a line.
+
+	LogView(QWidget* parent = 0);
+
+	qint64 getMatchLine() const;
+	LogSourcePointer getSource() const;
+	void setSource(LogSourcePointer source);
+	void setText(const QString& text);
+
+public slots:
+	void clear();
+	void find(const QString& text);
+	void findNext();
+	void findPrevious();
+};
+
+/*! \brief Retrieves the line of the current match of the search.
+ *
+ * \return The line, or -1 if there is no match.
+ */
+inline qint64 LogView::getMatchLine() const { return matchLine; }
+
+/*! \brief Retrieves the lines shown.
+ */
+inline LogSourcePointer LogView::getSource() const { return source; }
+
+#endif /* LOGVIEW_H_ */
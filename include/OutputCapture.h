@@ -0,0 +1,89 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * OutputCapture.h - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef OUTPUTCAPTURE_H_
+#define OUTPUTCAPTURE_H_
+
+#include <QByteArray>
+#include <QMetaType>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+class QTemporaryFile;
+
+/*! \brief Captures a stream of output in bounded memory.
+ *
+ * Only the most recent bytes of the output are held in memory, in a ring
+ * that grows with the output up to a fixed capacity, so a process that
+ * prints little costs little. Older bytes are appended to a spill file as
+ * they are pushed out of the ring, so memory stays flat however much a test
+ * prints while the whole output can still be read back. The offset of every
+ * getLineIndexStride()'th line is kept so that the output can be paged
+ * through by line without scanning it from the start. The stride doubles
+ * whenever the index would exceed MAX_LINE_INDEX_SIZE entries, which bounds
+ * its memory however many lines are captured.
+ * The engine appends to a capture from its thread while the GUI reads it,
+ * so every member function is thread-safe.
+ */
+class OutputCapture {
+
+private:
+	mutable QMutex mutex;		//!< Guards every member below.
+	QByteArray ring;			//!< The most recent bytes, stored circularly.
+	int capacity;				//!< The size 'ring' grows to at most.
+	int ringStart;				//!< The position in 'ring' of the oldest byte held.
+	int ringLength;				//!< The number of bytes held in 'ring'.
+	qint64 totalSize;			//!< The number of bytes captured, spilled or not.
+	QTemporaryFile* spill;		//!< The bytes pushed out of the ring, or null until there are any.
+	qint64 spilledSize;			//!< The number of bytes in 'spill'.
+	int lineIndexStride;		//!< The number of lines between two entries of 'lineIndex'.
+	QVector<qint64> lineIndex;	//!< The offset of line i*lineIndexStride at entry i.
+	qint64 newlineCount;		//!< The number of newlines captured.
+	QString spillError;			//!< The error of the first failed write to 'spill', or empty.
+
+	void growRing(int length);
+	QByteArray readLocked(qint64 offset, int length) const;
+	void spillBytes(const char* data, int length);
+
+public:
+	static const int DEFAULT_CAPACITY = 1024 * 1024;	//!< The default size of the in-memory ring.
+	static const int DEFAULT_LINE_INDEX_STRIDE = 256;	//!< The default number of lines between two indexed offsets.
+	static const int MAX_LINE_INDEX_SIZE = 64 * 1024;	//!< The most entries of the line index.
+
+	OutputCapture(int capacity = DEFAULT_CAPACITY, int lineIndexStride = DEFAULT_LINE_INDEX_STRIDE);
+	virtual ~OutputCapture();
+
+	void append(const QByteArray& data);
+	qint64 getLineAt(qint64 offset) const;
+	qint64 getLineCount() const;
+	qint64 getLineOffset(qint64 line) const;
+	int getLineIndexStride() const;
+	qint64 getSize() const;
+	qint64 getSpilledSize() const;
+	QString getSpillError() const;
+	QByteArray read(qint64 offset, int length) const;
+	QByteArray readLines(qint64 firstLine, int count) const;
+};
+
+/*! \brief A capture shared by the engine that fills it and the executable that owns it.
+ */
+typedef QSharedPointer<OutputCapture> OutputCapturePointer;
+
+Q_DECLARE_METATYPE(OutputCapturePointer);
+
+#endif /* OUTPUTCAPTURE_H_ */
@@ -0,0 +1,73 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * ResultArena.h - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef RESULTARENA_H_
+#define RESULTARENA_H_
+
+#include <QList>
+#include <QVector>
+
+#include <new>
+
+class GTestResults;
+
+/*! \brief Allocates the results of a run in large blocks and releases them all at once.
+ *
+ * A run may leave a million GTestResults behind, and allocating and freeing
+ * each on its own costs time and fragments the heap of a runner that keeps
+ * rerunning. The results of a run are instead created in the blocks of an
+ * arena, which are freed together once the run's results are superseded.
+ * The objects' destructors are still run on release, but nothing is freed
+ * per object. Objects created in an arena must never be deleted.
+ */
+class ResultArena {
+
+private:
+	static const int BLOCK_SIZE = 64 * 1024;	//!< The size of a block.
+
+	QList<char*> blocks;			//!< The blocks, the one being filled last.
+	size_t blockUsed;				//!< The number of bytes used of the last block.
+	QVector<GTestResults*> objects;	//!< The objects created, in order.
+
+	void* allocate(size_t size);
+
+	ResultArena(const ResultArena&);
+	ResultArena& operator=(const ResultArena&);
+
+public:
+	ResultArena();
+	~ResultArena();
+
+	template<class T> T* create();
+	int getObjectCount() const;
+	void release();
+};
+
+/*! \brief Creates a default constructed result object in the arena.
+ *
+ * \return The object, which the arena owns.
+ */
+template<class T> inline T* ResultArena::create() {
+	T* object = new(allocate(sizeof(T))) T();
+	objects.append(object);
+	return object;
+}
+
+/*! \brief Retrieves the number of objects created in the arena since it was last released.
+ */
+inline int ResultArena::getObjectCount() const { return objects.size(); }
+
+#endif /* RESULTARENA_H_ */
@@ -0,0 +1,199 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * TestEngine.h - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TESTENGINE_H_
+#define TESTENGINE_H_
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMetaType>
+#include <QObject>
+#include <QPair>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+
+#include "GTestExecutableResults.h"
+#include "OutputCapture.h"
+
+class QSocketNotifier;
+class QTcpServer;
+class QTcpSocket;
+class QTimer;
+
+/*! \brief The progress of a test as reported by a running gtest process.
+ */
+struct TestEvent {
+
+	/*! \brief What has happened to the test.
+	 */
+	enum TYPE {
+		BEGIN = 0,	//!< The test has started.
+		PASSED,		//!< The test has finished and passed.
+		FAILED,		//!< The test has finished and failed.
+		FAILURE,	//!< An assertion of the test has failed.
+		OUTPUT		//!< The range of the test's console output is known.
+	};
+
+	TYPE type;		//!< What has happened to the test.
+	QString name;	//!< The name of the test in the form "suitename.testname".
+	int duration;	//!< For PASSED and FAILED, the running time in milliseconds, or -1 if unknown.
+	QString file;	//!< For FAILURE, the source file of the assertion, if known.
+	int line;		//!< For FAILURE, the line of the assertion, or -1 if unknown.
+	QString message;	//!< For FAILURE, the message of the assertion, if known.
+	qint64 outputStart;	//!< For OUTPUT, the offset in the standard output of the test's "[ RUN      ]" line.
+	qint64 outputEnd;	//!< For OUTPUT, the offset just past the test's last line of output.
+
+	TestEvent() : type(BEGIN), name(), duration(-1), file(), line(-1), message(), outputStart(-1), outputEnd(-1) {}
+};
+
+/*! \brief A parsed test listing: each suite's name with the names of its tests, in order.
+ */
+typedef QList<QPair<QString, QStringList> > TestListing;
+
+/*! \brief Runs gtest processes and parses their output away from the GUI thread.
+ *
+ * The engine lives in a thread of its own. It owns every gtest process, reads
+ * their pipes, scans their output for test progress and parses listings and
+ * result files, so that none of this work blocks the GUI or delays the
+ * draining of another process's pipes. It is driven through its slots, which
+ * are invoked with queued connections, and hands only compact, parsed results
+ * back through its signals. Each process is identified by a job id from
+ * createJobId() so that the executables sharing the engine can tell which
+ * signals are theirs.
+ * On Unix, each test process also inherits the write end of a pipe, named in
+ * the GTESTRUNNER_EVENT_FD environment variable. Executables linked with the
+ * listener library report their progress on it as TestEventRecords, and once
+ * a record arrives the console output of that process is no longer scanned.
+ * Otherwise, each test process is asked to stream its events to a local
+ * QTcpServer with --gtest_stream_result_to, and once it connects the
+ * console output is no longer scanned for progress either. As the last
+ * events of a stream may arrive after its process has exited, such a job
+ * is only completed once the stream is closed, without blocking the thread. Only executables that
+ * support neither are followed through their console output. The console
+ * output is still scanned for the range each test's output takes up in it.
+ * Result files are parsed on the global QThreadPool, one task per file, so
+ * that the files of many shards and executables finishing together are
+ * parsed at once rather than one after another on the engine's thread.
+ */
+class TestEngine : public QObject {
+
+Q_OBJECT
+
+private:
+
+	static const int STREAM_CLOSE_TIMEOUT = 1000;	//!< The most milliseconds a job waits for its result stream to close once its process has exited.
+
+	/*! \brief A process run by the engine.
+	 */
+	struct Job {
+		QProcess* process;		//!< The running process.
+		bool listing;			//!< Whether the process lists the tests rather than running them.
+		QByteArray output;		//!< The standard output read so far, for a listing.
+		OutputCapturePointer standardOutput;	//!< Captures the standard output of a test process.
+		OutputCapturePointer standardError;		//!< Captures the standard error of the process.
+		qint64 outputSize;		//!< The number of bytes of standard output read.
+		QByteArray partialLine;	//!< The start of the output's last line, until its newline is read.
+		qint64 partialLineOffset;	//!< The offset of 'partialLine' in the standard output.
+		QString outputTest;		//!< The test whose output is being read, or empty between tests.
+		qint64 outputTestStart;	//!< The offset of the "[ RUN      ]" line of 'outputTest'.
+		int channel;			//!< The read end of the process's event channel, or -1.
+		QSocketNotifier* channelNotifier; //!< Notifies when records can be read from 'channel'.
+		QByteArray records;		//!< Records read from 'channel' that are still incomplete.
+		bool recordEvents;		//!< Whether the process reports its progress on 'channel'.
+		QTcpServer* streamServer;	//!< Listens for the process's result stream, or null.
+		QTcpSocket* stream;		//!< The process's result stream, or null until it connects.
+		QString streamSuite;	//!< The name of the suite the result stream is in.
+		QString streamTest;		//!< The full name of the test the result stream is in.
+		bool streamEvents;		//!< Whether the process reports its progress on 'stream'.
+		int exitCode;			//!< The exit code of the process, once it has exited.
+		QProcess::ExitStatus exitStatus;	//!< The exit status of the process, once it has exited.
+		QTimer* finishTimer;	//!< Bounds the wait for 'stream' to close once the process has exited, or null.
+	};
+
+	/*! \brief The result files of a run being parsed by the thread pool.
+	 */
+	struct ParseJob {
+		GTestExecutableResults* results;	//!< The results of the files parsed so far, merged, or null.
+		int pending;					//!< The number of files still being parsed.
+	};
+
+	QHash<int, Job> jobs;			//!< The running processes, by job id.
+	QHash<int, ParseJob> parseJobs;	//!< The runs whose result files are being parsed, by job id.
+	QHash<QObject*, int> parseJobIds;	//!< The job id of each result file being parsed, by the watcher of its task.
+	QHash<QProcess*, int> jobIds;	//!< The job id of each running process.
+	QHash<int, int> channelJobs;	//!< The job id of each open event channel.
+	QHash<QObject*, int> streamJobs;	//!< The job id of each result stream server and socket.
+	QHash<QObject*, int> finishTimers;	//!< The job id of each exited process waiting for its result stream, by its finish timer.
+	static QAtomicInt nextJobId;	//!< The id handed out by the next createJobId().
+
+	void acceptStream(int id, Job& job);
+	void closeChannel(Job& job);
+	void closeStream(Job& job);
+	void completeJob(int id);
+	void finishJob(int id, int exitCode, QProcess::ExitStatus exitStatus);
+	void pollStream(int id, Job& job);
+	QList<TestEvent> readRecords(Job& job);
+	QList<TestEvent> readStream(Job& job);
+	static bool parseStreamLine(const QByteArray& line, Job& job, TestEvent* event);
+	QList<TestEvent> readStandardOutput(Job& job);
+	QList<TestEvent> scanOutput(Job& job, const QByteArray& chunk);
+	void scanLine(Job& job, const char* line, const char* end, qint64 lineStart, qint64 lineEnd, QList<TestEvent>& events);
+	void startJob(int id, bool listing, const QString& program, const QStringList& arguments, const QStringList& environment,
+				  OutputCapturePointer standardOutput, OutputCapturePointer standardError);
+
+private slots:
+	void channelReadable(int channel);
+	void finishTimeout();
+	void processError(QProcess::ProcessError error);
+	void processFinished(int exitCode, QProcess::ExitStatus exitStatus);
+	void resultFileParsed();
+	void standardErrorAvailable();
+	void standardOutputAvailable();
+	void streamConnected();
+	void streamDisconnected();
+	void streamReadable();
+
+signals:
+	void jobFinished(int job, int exitCode, int exitStatus, int error); //!< Sent when a test process has exited and its output has been captured.
+	void listingFinished(int job, int exitCode, int exitStatus, int error, TestListing listing, QByteArray output); //!< Sent when a listing has been produced and parsed.
+	void resultsParsed(int job, GTestExecutableResults* results); //!< Sent with the merged results of parseResults(), which the receiver takes ownership of.
+	void testEvents(int job, QList<TestEvent> events); //!< Sent with the progress read from a test process since the last events.
+
+public slots:
+	void kill(int job);
+	void parseListing(int job, QByteArray output);
+	void parseResults(int job, QStringList paths);
+	void startListing(int job, QString program);
+	void startTests(int job, QString program, QStringList arguments, QStringList environment,
+					OutputCapturePointer standardOutput, OutputCapturePointer standardError);
+
+public:
+	TestEngine(QObject* parent = 0);
+	virtual ~TestEngine();
+
+	static int createJobId();
+	static TestListing parseListingOutput(const QByteArray& output);
+	static GTestExecutableResults* parseResultFile(const QString& path);
+	static bool scanLine(const char* line, const char* end, TestEvent* event);
+};
+
+Q_DECLARE_METATYPE(TestEvent);
+Q_DECLARE_METATYPE(GTestExecutableResults*);
+
+#endif /* TESTENGINE_H_ */
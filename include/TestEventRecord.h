@@ -0,0 +1,82 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * TestEventRecord.h - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TESTEVENTRECORD_H_
+#define TESTEVENTRECORD_H_
+
+#include <stdint.h>
+
+/*! \brief The environment variable giving the event channel's file descriptor.
+ *
+ * The runner creates a pipe for each test process and sets this variable to
+ * the number of its write end, which the process inherits. The listener
+ * library writes its records to it.
+ */
+#define GTESTRUNNER_EVENT_FD "GTESTRUNNER_EVENT_FD"
+
+/*! \brief The value of the 'magic' field of every record.
+ *
+ * Listeners from before records were versioned start with a record type
+ * of 1 to 3, so they can never be mistaken for a versioned one.
+ */
+#define TEST_EVENT_RECORD_MAGIC 0x4752
+
+/*! \brief The version of the record layout, raised whenever it changes.
+ *
+ * The runner drops the event channel of a process whose records are of
+ * another version and follows it through its console output instead.
+ */
+#define TEST_EVENT_RECORD_VERSION 2
+
+/*! \brief The largest record the runner accepts, header included.
+ *
+ * The listener cuts failure messages short to stay within it. A larger
+ * record can only be garbage, so the runner drops the channel.
+ */
+#define TEST_EVENT_RECORD_MAX_SIZE (16 * 1024 * 1024)
+
+/*! \brief The kinds of record written to the event channel.
+ */
+enum TestEventRecordType {
+	TEST_START_RECORD = 1,	//!< A test has started.
+	TEST_END_RECORD = 2,	//!< A test has ended, with its status and duration.
+	TEST_FAILURE_RECORD = 3	//!< An assertion of the running test has failed, with its location and message.
+};
+
+/*! \brief The fixed size header of a record on the event channel.
+ *
+ * Both ends of the channel run on the same machine, so the header is
+ * written in host byte order. It is followed by 'nameLength' bytes of the
+ * test's name, in the form "suitename.testname", then 'fileLength' bytes of
+ * the failure's source file and, for a failure, 'messageLength' bytes of its
+ * message. None of the strings is null terminated.
+ */
+struct TestEventRecord {
+	uint16_t magic;			//!< TEST_EVENT_RECORD_MAGIC.
+	uint8_t version;		//!< TEST_EVENT_RECORD_VERSION.
+	uint8_t type;			//!< One of TestEventRecordType.
+	uint8_t failed;			//!< For TEST_END_RECORD, whether the test failed.
+	uint8_t reserved[3];	//!< Zero.
+	uint16_t fileLength;	//!< The length of the source file name that follows the name.
+	uint32_t nameLength;	//!< The length of the test name that follows the header.
+	union {
+		uint32_t duration;		//!< For TEST_END_RECORD, the running time of the test in milliseconds.
+		uint32_t messageLength;	//!< For TEST_FAILURE_RECORD, the length of the message that follows the file name.
+	};
+	int32_t line;			//!< For TEST_FAILURE_RECORD, the line of the failure, or -1 if unknown.
+};
+
+#endif /* TESTEVENTRECORD_H_ */
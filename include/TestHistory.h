@@ -0,0 +1,73 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * TestHistory.h - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TESTHISTORY_H_
+#define TESTHISTORY_H_
+
+#include <QHash>
+#include <QString>
+
+class GTestExecutableResults;
+
+/*! \brief Keeps the running time of every test from previous runs.
+ *
+ * The durations are taken from the "time" attribute of each testcase in
+ * the results, smoothed over successive runs, and stored on disk so that
+ * they survive between sessions. They are used to estimate how long a set
+ * of tests will take so that work can be scheduled longest first.
+ * Recording durations only changes the history in memory. Its owner saves
+ * it once isModified(), at a time of its choosing, as rewriting the file
+ * after every run would be wasteful.
+ */
+class TestHistory {
+
+private:
+	QString filePath;	//!< The file the history is loaded from and saved to.
+	QHash<QString, QHash<QString, double> > durations; //!< Maps executable path to "suite.test" to seconds.
+	double totalDuration;	//!< The sum of all recorded durations.
+	int totalCount;			//!< The number of recorded durations.
+	bool modified;			//!< Whether durations were recorded since the history was loaded or saved.
+
+public:
+	TestHistory(QString filePath = QString());
+	~TestHistory();
+
+	double estimate(const QString& executable, const QString& testName) const;
+	double getDuration(const QString& executable, const QString& testName) const;
+	QString getFilePath() const;
+	bool hasHistory(const QString& executable) const;
+	bool isModified() const;
+	bool load();
+	void record(const QString& executable, const QString& testName, double seconds);
+	void recordResults(const QString& executable, GTestExecutableResults* results);
+	bool save();
+};
+
+/*! \brief Retrieves the path of the file the history is kept in.
+ */
+inline QString TestHistory::getFilePath() const { return filePath; }
+
+/*! \brief Whether any duration has been recorded for the executable.
+ *
+ * \param executable The path of the executable.
+ */
+inline bool TestHistory::hasHistory(const QString& executable) const { return durations.contains(executable); }
+
+/*! \brief Whether durations were recorded that haven't been saved yet.
+ */
+inline bool TestHistory::isModified() const { return modified; }
+
+#endif /* TESTHISTORY_H_ */
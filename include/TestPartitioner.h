@@ -0,0 +1,81 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * TestPartitioner.h - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TESTPARTITIONER_H_
+#define TESTPARTITIONER_H_
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+/*! \brief Splits a set of tests into shards of roughly equal running time.
+ *
+ * gtest's own sharding assigns tests to shards round-robin, which can leave
+ * all of the slow tests in a single shard. This partitioner instead uses the
+ * estimated duration of each test to bin-pack them: the tests are placed
+ * longest first into the least loaded shard, and the result is then refined
+ * by moving or swapping tests out of the most loaded shard while doing so
+ * shortens it. Each shard can then be run with its own --gtest_filter.
+ */
+class TestPartitioner {
+
+private:
+	/*! \brief A test and its estimated running time.
+	 */
+	struct Item {
+		QString name;		//!< The name of the test in the form "suite.test".
+		double estimate;	//!< The estimated running time in seconds.
+	};
+
+	QList<Item> items;				//!< The tests to partition.
+	QList<QList<Item> > bins;		//!< The tests assigned to each shard.
+	QList<double> loads;			//!< The estimated running time of each shard.
+
+	static bool longerThan(const Item& a, const Item& b);
+	int heaviestBin() const;
+	int lightestBin() const;
+	bool refine();
+
+public:
+	TestPartitioner(int binCount);
+	~TestPartitioner();
+
+	void addTest(const QString& name, double estimate);
+	int getBinCount() const;
+	double getEstimate(int bin) const;
+	QList<double> getEstimates() const;
+	double getMakespan() const;
+	QStringList getTests(int bin) const;
+	void partition();
+};
+
+/*! \brief Retrieves the number of shards the tests are split into.
+ */
+inline int TestPartitioner::getBinCount() const { return bins.size(); }
+
+/*! \brief Retrieves the estimated running time of a shard.
+ *
+ * This is only meaningful after partition() has been called.
+ * \param bin The index of the shard.
+ * \return The sum of the estimates of the shard's tests, in seconds.
+ */
+inline double TestPartitioner::getEstimate(int bin) const { return loads.value(bin); }
+
+/*! \brief Retrieves the estimated running time of every shard.
+ */
+inline QList<double> TestPartitioner::getEstimates() const { return loads; }
+
+#endif /* TESTPARTITIONER_H_ */
@@ -0,0 +1,97 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * TestScheduler.h - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TESTSCHEDULER_H_
+#define TESTSCHEDULER_H_
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+
+class GTestExecutable;
+
+/*! \brief A unit of work queued on the TestScheduler.
+ */
+struct RunUnit {
+	int shardIndex;		//!< The shard of the executable this unit runs.
+	double estimate;	//!< The estimated running time of the unit in seconds.
+};
+
+/*! \brief Schedules the run units of every loaded executable onto a fixed number of processes.
+ *
+ * Rather than every GTestExecutable launching its processes as soon as a run
+ * is requested, each executable submits its run units (whole executables or
+ * shards of one) to the scheduler. The scheduler keeps at most
+ * getMaxProcesses() of them running at once. Whenever a process slot becomes
+ * idle it starts the queued unit with the longest estimated running time
+ * (longest processing time first), preferring the executable with the longest
+ * remaining backlog when estimates are equal. Slots that would otherwise idle
+ * thus steal work from the executables that would finish last, and the
+ * slowest units never end up as the tail of a run.
+ * An executable that is destroyed has its backlog dropped and the slots
+ * of its running units freed.
+ */
+class TestScheduler : public QObject {
+
+Q_OBJECT
+
+private:
+	int maxProcesses;		//!< The maximum number of processes running at once.
+	int runningProcesses;	//!< The number of processes currently running.
+	bool dispatchPending;	//!< Whether a dispatch() has been queued on the event loop.
+	QList<GTestExecutable*> executables; //!< The executables with a backlog, in submission order.
+	QHash<GTestExecutable*, QList<RunUnit> > backlog; //!< The units each executable has yet to start, longest first.
+	QHash<GTestExecutable*, int> launched; //!< The number of units of each executable that are running.
+
+	GTestExecutable* nextExecutable() const;
+	void scheduleDispatch();
+
+private slots:
+	void dispatch();
+	void executableDestroyed(QObject* executable);
+	void unitFinished();
+
+signals:
+	void idle(); //!< Sent when the last running unit has finished and nothing is queued.
+
+public:
+	TestScheduler(QObject* parent = 0);
+	virtual ~TestScheduler();
+
+	int cancel(GTestExecutable* executable);
+	int getBacklog(GTestExecutable* executable) const;
+	int getMaxProcesses() const;
+	int getRunningProcesses() const;
+	void setMaxProcesses(int maxProcesses);
+	void submit(GTestExecutable* executable, const QList<double>& estimates);
+};
+
+/*! \brief Retrieves the number of units the executable has yet to start.
+ *
+ * \param executable The executable to query.
+ * \return The number of units still queued for 'executable'.
+ */
+inline int TestScheduler::getBacklog(GTestExecutable* executable) const { return backlog.value(executable).size(); }
+
+/*! \brief Retrieves the maximum number of processes the scheduler keeps running.
+ */
+inline int TestScheduler::getMaxProcesses() const { return maxProcesses; }
+
+/*! \brief Retrieves the number of processes the scheduler currently has running.
+ */
+inline int TestScheduler::getRunningProcesses() const { return runningProcesses; }
+
+#endif /* TESTSCHEDULER_H_ */
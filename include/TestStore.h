@@ -0,0 +1,205 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * TestStore.h - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TESTSTORE_H_
+#define TESTSTORE_H_
+
+#include <QBitArray>
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <qnamespace.h>
+
+/*! \brief A compact store of the suites and tests listed by a gtest executable.
+ *
+ * Executables with hundreds of thousands of (parameterised) tests can't afford
+ * an object per test. Instead, the store keeps each property of the suites and
+ * tests in its own contiguous array indexed by an integer id: the interned name,
+ * the parent suite, the row within the parent, the check state and the result
+ * status. Names are interned so that the many tests sharing a name (e.g. the
+ * instances of a parameterised test) share a single string.
+ *
+ * Ids are never reused. When a suite or test disappears from the listing it is
+ * marked as removed (its row becomes -1) and its id is left unused. Because
+ * new suites and tests are always appended, the ids added by the last listing
+ * are those from getFirstNewSuite() and getFirstNewTest() onwards.
+ *
+ * The per suite counts of checked, passed and failed tests are maintained as
+ * the states change, so the aggregate state of a suite or of the whole
+ * executable is available without visiting its tests.
+ */
+class TestStore {
+
+public:
+
+	/*! \brief The result status of a test.
+	 */
+	enum STATUS {
+		NOT_RUN = 0,	//!< The test hasn't been run (or wasn't run by gtest).
+		RUNNING,		//!< The test has started but not yet finished.
+		PASSED,			//!< The test passed.
+		FAILED			//!< The test failed.
+	};
+
+private:
+	QStringList strings;			//!< The interned names.
+	QHash<QString, int> stringIds;	//!< Maps each interned name to its id.
+
+	QVector<int> suiteNames;		//!< The name id of each suite.
+	QVector<int> suiteRows;			//!< The row of each suite, -1 if removed.
+	QVector<QVector<int> > suiteTests; //!< The ids of each suite's tests, in order.
+	QVector<int> suiteChecked;		//!< The number of checked tests in each suite.
+	QVector<int> suitePassed;		//!< The number of passed tests in each suite.
+	QVector<int> suiteFailed;		//!< The number of failed tests in each suite.
+	QVector<int> suiteOrder;		//!< The ids of the suites, in order.
+	QHash<int, int> suiteIndex;		//!< Maps a suite name id to the suite id.
+	QBitArray suiteSeen;			//!< Which suites were seen by the current listing.
+
+	QVector<int> testNames;			//!< The name id of each test.
+	QVector<int> testSuites;		//!< The id of the suite of each test.
+	QVector<int> testRows;			//!< The row of each test in its suite, -1 if removed.
+	QVector<quint8> testCheckStates;//!< The check state of each test.
+	QVector<quint8> testStatuses;	//!< The STATUS of each test.
+	QHash<QPair<int, int>, int> testIndex; //!< Maps (suite id, name id) to the test id.
+	QBitArray testSeen;				//!< Which tests were seen by the current listing.
+
+	int firstNewSuite;				//!< The first suite id added by the last listing.
+	int firstNewTest;				//!< The first test id added by the last listing.
+
+	int intern(const QString& name);
+	void countStatus(int suite, quint8 status, int delta);
+
+public:
+	TestStore();
+	~TestStore();
+
+	int addSuite(const QString& name);
+	int addTest(int suite, const QString& name);
+	void beginListing();
+	void endListing();
+
+	int findSuite(const QString& name) const;
+	int findTest(const QString& fullName) const;
+	int findTest(int suite, const QString& name) const;
+
+	int getCheckedTestCount() const;
+	Qt::CheckState getCheckState() const;
+	int getFirstNewSuite() const;
+	int getFirstNewTest() const;
+	STATUS getStatus() const;
+	int getSuite(int row) const;
+	Qt::CheckState getSuiteCheckState(int suite) const;
+	int getSuiteCount() const;
+	int getSuiteIdCount() const;
+	QString getSuiteName(int suite) const;
+	int getSuiteRow(int suite) const;
+	STATUS getSuiteStatus(int suite) const;
+	int getTest(int suite, int row) const;
+	Qt::CheckState getTestCheckState(int test) const;
+	int getTestCount() const;
+	int getTestCount(int suite) const;
+	int getTestIdCount() const;
+	QString getTestFullName(int test) const;
+	QString getTestName(int test) const;
+	int getTestRow(int test) const;
+	STATUS getTestStatus(int test) const;
+	int getTestSuite(int test) const;
+	void resetStatuses();
+	void setCheckState(Qt::CheckState state);
+	void setSuiteCheckState(int suite, Qt::CheckState state);
+	void setTestCheckState(int test, Qt::CheckState state);
+	void setTestStatus(int test, STATUS status);
+};
+
+/*! \brief Retrieves the first suite id added by the last listing.
+ *
+ * Every id from this one to getSuiteIdCount()-1 was added by the last listing.
+ */
+inline int TestStore::getFirstNewSuite() const { return firstNewSuite; }
+
+/*! \brief Retrieves the first test id added by the last listing.
+ *
+ * Every id from this one to getTestIdCount()-1 was added by the last listing.
+ */
+inline int TestStore::getFirstNewTest() const { return firstNewTest; }
+
+/*! \brief Retrieves the id of the suite in row 'row'.
+ *
+ * \return The suite id, or -1 if the row is out of range.
+ */
+inline int TestStore::getSuite(int row) const { return suiteOrder.value(row, -1); }
+
+/*! \brief Retrieves the number of suites in the listing.
+ */
+inline int TestStore::getSuiteCount() const { return suiteOrder.size(); }
+
+/*! \brief Retrieves the number of suite ids allocated, including removed suites.
+ */
+inline int TestStore::getSuiteIdCount() const { return suiteNames.size(); }
+
+/*! \brief Retrieves the name of a suite.
+ */
+inline QString TestStore::getSuiteName(int suite) const { return strings.value(suiteNames.value(suite, -1)); }
+
+/*! \brief Retrieves the row of a suite.
+ *
+ * \return The row, or -1 if the suite has been removed.
+ */
+inline int TestStore::getSuiteRow(int suite) const { return suiteRows.value(suite, -1); }
+
+/*! \brief Retrieves the id of the test in row 'row' of the suite.
+ *
+ * \return The test id, or -1 if the row is out of range.
+ */
+inline int TestStore::getTest(int suite, int row) const { return suiteTests.value(suite).value(row, -1); }
+
+/*! \brief Retrieves the check state of a test.
+ */
+inline Qt::CheckState TestStore::getTestCheckState(int test) const { return static_cast<Qt::CheckState>(testCheckStates.value(test, Qt::Unchecked)); }
+
+/*! \brief Retrieves the number of tests in the suite.
+ */
+inline int TestStore::getTestCount(int suite) const { return suiteTests.value(suite).size(); }
+
+/*! \brief Retrieves the number of test ids allocated, including removed tests.
+ */
+inline int TestStore::getTestIdCount() const { return testNames.size(); }
+
+/*! \brief Retrieves the name of a test (without its suite).
+ */
+inline QString TestStore::getTestName(int test) const { return strings.value(testNames.value(test, -1)); }
+
+/*! \brief Retrieves the name of a test in the form "suitename.testname".
+ */
+inline QString TestStore::getTestFullName(int test) const { return getSuiteName(getTestSuite(test)) + '.' + getTestName(test); }
+
+/*! \brief Retrieves the row of a test in its suite.
+ *
+ * \return The row, or -1 if the test has been removed.
+ */
+inline int TestStore::getTestRow(int test) const { return testRows.value(test, -1); }
+
+/*! \brief Retrieves the result status of a test.
+ */
+inline TestStore::STATUS TestStore::getTestStatus(int test) const { return static_cast<STATUS>(testStatuses.value(test, NOT_RUN)); }
+
+/*! \brief Retrieves the id of the suite a test belongs to.
+ */
+inline int TestStore::getTestSuite(int test) const { return testSuites.value(test, -1); }
+
+#endif /* TESTSTORE_H_ */
@@ -20,23 +20,35 @@
 #include <QMainWindow>
 #include <QAbstractItemModel>
 #include <QAbstractItemView>
-#include <QPlainTextEdit>
 #include <QHash>
 #include <QModelIndex>
+#include <QSet>
 #include <QSharedPointer>
 #include <QVariant>
 
+#include "TestStore.h"
 #include "TreeModel.h"
 
 class TreeItem;
-class GTest;
 class GTestExecutable;
+class ListingCache;
+class LogView;
+class TestHistory;
+class TestEngine;
+class TestScheduler;
+class QThread;
+class QTimer;
 
 /*! \brief The data model that holds the unit test application hierarchy.
  *
  * The unit test hierarchy is structured as a collection of trees. These
  * are each held as branches of an invisible root node (which conveniently
  * holds the model's header data).
+ * Only the executables' items hold data of their own. The items of suites
+ * and tests hold their id in the executable's TestStore, from which their
+ * name, check state and status are looked up. The rows of the items are
+ * kept the same as the rows of the store. The items of a suite's tests are
+ * created in chunks as the view fetches them.
  */
 class TestTreeModel : public TreeModel {
 
@@ -54,24 +66,57 @@ private:
 		TO_CHILDREN = 0x2
 	};
 
-	QHash<QString, QSharedPointer<GTestExecutable> > testExeHash; //!< A hash of all loaded gtest executables.
-	QHash<GTest*, TreeItem* > itemTestHash; //!< A hash that relates unit tests to tree items
+	/*! \brief The depth of an item in the unit test tree hierarchy.
+	 */
+	enum LEVEL {
+		ROOT = 0,
+		EXECUTABLE,
+		SUITE,
+		TEST
+	};
 
-	template <class T, class U>
-	TreeItem* createNewTreeItem(T parent, U* test);
-	bool setCheckState(TreeItem* item, Qt::CheckState state, int recursionDirection = (TO_PARENT | TO_CHILDREN));
-    QAtomicInt m_processCount;
-    QPlainTextEdit *m_result;
+	QHash<QString, QSharedPointer<GTestExecutable> > testExeHash; //!< A hash of all loaded gtest executables.
+	QHash<GTestExecutable*, TreeItem* > itemExeHash; //!< A hash that relates executables to tree items
+
+	TreeItem* createNewTreeItem(GTestExecutable* gtest);
+	void emitChanged(TreeItem* item, int recursionDirection = NONE);
+	void emitChildrenChanged(TreeItem* item);
+	void emitRowsChanged(TreeItem* parent, QList<int> rows);
+	GTestExecutable* executableOf(TreeItem* item) const;
+	TreeItem* itemOf(GTestExecutable* gtest, int test) const;
+	TreeItem* suiteItemOf(GTestExecutable* gtest, int suite) const;
+	LEVEL levelOf(TreeItem* item) const;
+	void removeUnlisted(TreeItem* exeTreeItem, const TestStore& store);
+	bool setCheckState(TreeItem* item, Qt::CheckState state);
+	static QVariant statusBrush(TestStore::STATUS status);
+    QHash<int, GTestExecutable*> m_RunJobs; //!< The run jobs that haven't ended yet, with their executables.
+    LogView *m_result; //!< Shows the results and the output of the current item.
     QMainWindow *m_MainWindow;
+    int m_ShardCount; //!< The shard count given to new executables, 0 for their default.
+    bool m_JsonResults; //!< Whether new executables write their results as .json.
+    int m_KeptRuns; //!< The number of previous runs new executables keep, -1 for their default.
+    TestScheduler *m_Scheduler; //!< Keeps a bounded number of test processes busy across all executables.
+    TestHistory *m_History; //!< The durations of previous runs of every executable.
+    ListingCache *m_ListingCache; //!< The listings of every executable, kept across sessions.
+    QThread *m_EngineThread; //!< The thread that the test processes are run and parsed on.
+    TestEngine *m_Engine; //!< Runs the test processes of every executable on m_EngineThread.
+    QTimer *m_ProgressTimer; //!< Limits how often the progress of the running tests is shown.
+    QTimer *m_HistoryTimer; //!< Limits how often the durations of the finished runs are saved.
+    QHash<GTestExecutable*, QSet<int> > m_EndedTests; //!< The tests that have ended since the progress was last shown.
+    GTestExecutable *m_BegunExecutable; //!< The executable of the test that began last, or null.
+    int m_BegunTest; //!< The test that began last.
 
 private slots:
 	void updateListing(GTestExecutable* gtest);
 	void updateAllListings();
-	void populateTestResult();
+	void populateTestResult(GTestExecutable* gtest);
+	void runJobEnded(GTestExecutable* gtest, int job);
 	void removeSelectedTests();
 	void runTests();
-    void BeginTest(GTest*);
-    void EndTest(GTest*, bool success);
+    void BeginTest(GTestExecutable* gtest, int test);
+    void EndTest(GTestExecutable* gtest, int test, bool success);
+    void showProgress();
+    void saveHistory();
 
 signals:
 	void aboutToRunTests(); //!< Sends a signal to any listeners to prepare for test runs.
@@ -87,11 +132,19 @@ public:
 		UNKNOWN
 	};
 
-    TestTreeModel(QObject* parent, QPlainTextEdit *result);
-    void ClearTestTreeBackground(TreeItem * treeItem);
+    TestTreeModel(QObject* parent, LogView *result);
+    void ClearTestTreeBackground();
 	~TestTreeModel();
     ERROR addDataSource(const QString filepath, const QString outputDir);
+    void setShardCount(int shardCount){ m_ShardCount = shardCount; }
+    void setJsonResults(bool jsonResults){ m_JsonResults = jsonResults; }
+    void setKeptRuns(int keptRuns){ m_KeptRuns = keptRuns; }
+    void setMaxProcesses(int maxProcesses);
+    void setHashListings(bool hashListings);
+	virtual bool canFetchMore(const QModelIndex& parent) const;
 	virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+	virtual void fetchMore(const QModelIndex& parent);
+	virtual bool hasChildren(const QModelIndex& parent = QModelIndex()) const;
 	virtual bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole);
 
 public slots:
@@ -35,6 +35,7 @@ class TreeItem {
 public:
 	TreeItem();
 	TreeItem(QList<QMap<int, QVariant> >& data, TreeItem* parent = 0);
+	TreeItem(int id, TreeItem* parent = 0);
 	virtual ~TreeItem();
 
 	void appendChild(TreeItem* child);
@@ -46,11 +47,14 @@ public:
 	QVariant data(int column, int role) const;
 	QList<QMap<int, QVariant> > data() const;
 	TreeItem* findChild(const QVariant& value, int role) const;
+	int getId() const;
 	bool insertChild(int row, TreeItem* child);
+	bool insertChildren(int row, const QList<TreeItem* >& children);
 	TreeItem* parent();
 	void removeAllChildren();
 	bool removeChild(TreeItem* child);
 	void removeChildAt(int index);
+	void removeChildren(int row, int count);
 	int row() const;
 	bool setData(const QVariant& value, int column, int role);
 	bool setData(const QList<QMap<int, QVariant> >& data);
@@ -58,14 +62,28 @@ public:
 
 
 private:
+	void renumberChildren();
+
 	QList<TreeItem* > childItems; //!< The children of the TreeItem
 	//!< The data for this item, first indexed by column, then by role.
 	QList<QMap<int, QVariant> > itemData;
 	TreeItem* parentItem;        //!< The parent of this item.	
+	int id;						 /*!< The id of the item's data when it is held by the model
+								  *   rather than by the item, -1 otherwise. */
+	int itemRow;				 /*!< The last known row of this item in its parent.
+								  *   Checked and, if stale, refreshed by row(). */
 };
 
 Q_DECLARE_METATYPE(TreeItem*);
 
+/*! \brief Retrieves the id of the data this item shows.
+ *
+ * Items created with an id hold no data of their own. Their model looks up
+ * the data for each role by the id instead.
+ * \return The id, or -1 if the item holds its own data.
+ */
+inline int TreeItem::getId() const { return id; }
+
 /*! \brief Removes all children from this tree item.
  *
  * This removes all the children from the tree item. The caller should
@@ -83,12 +101,30 @@ inline void TreeItem::removeAllChildren() { childItems.clear(); }
  */
 inline void TreeItem::removeChildAt(int index) { childItems.removeAt(index); }
 
+/*! \brief Removes 'count' children starting at row 'row'.
+ *
+ * As with removeChildAt(), the caller is responsible for deleting them.
+ * \param row The row of the first child to remove.
+ * \param count The number of children to remove.
+ */
+inline void TreeItem::removeChildren(int row, int count) {
+	if(row < 0 || count <= 0 || row + count > childItems.size())
+		return;
+	childItems.erase(childItems.begin() + row, childItems.begin() + row + count);
+}
+
 /*! \brief Removes the child given from this tree item.
  *
  * \param child The child to remove.
  * \return true if the child is removed, false otherwise.
  */
-inline bool TreeItem::removeChild(TreeItem* child) { return childItems.removeOne(child); }
+inline bool TreeItem::removeChild(TreeItem* child) {
+	int row = (child && child->parentItem == this) ? child->row() : -1;
+	if(row < 0)
+		return childItems.removeOne(child);
+	childItems.removeAt(row);
+	return true;
+}
 
 /*! \brief Retrieves a pointer to the child in row 'row'.
  *
@@ -133,8 +169,8 @@ inline bool TreeItem::insertChild(int row, TreeItem* child) {
 	if(child->parent())
 		child->parent()->removeChild(child);
 	child->setParent(this);
-	if(!childItems.contains(child))
-		childItems.insert(row, child);
+	child->itemRow = qMin(row, childItems.size());
+	childItems.insert(row, child);
 	return true;
 }
 
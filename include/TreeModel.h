@@ -32,6 +32,8 @@ protected:
 	TreeItem rootItem; //!< The root of the data model. It's data is shown in the header.
 	QItemSelectionModel* selectionModel; //!< A model to identify selected items in this model.
 
+	QModelIndex indexOf(TreeItem* item) const;
+
 public:
 	TreeModel(QObject* parent = 0);
 	virtual ~TreeModel();
@@ -41,6 +43,8 @@ public:
 	virtual QVariant headerData(int secton, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
 	virtual QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const;
 	virtual bool insertItem(TreeItem* item, int row, TreeItem* parent);
+	virtual bool insertItems(const QList<TreeItem* >& items, int row, TreeItem* parent);
+	virtual bool removeItems(int row, int count, TreeItem* parent);
 	virtual QModelIndex parent(const QModelIndex& index) const;
 	virtual int columnCount(const QModelIndex& parent = QModelIndex()) const;
 	virtual int rowCount(const QModelIndex& parent = QModelIndex()) const;
@@ -0,0 +1,139 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * GTestRunnerListener.cpp - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "GTestRunnerListener.h"
+#include "TestEventRecord.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vector>
+
+/*! \brief Installs the listener when the library is loaded.
+ */
+static const bool installed = GTestRunnerListener::install();
+
+/*! \brief Constructor
+ *
+ * \param fd The write end of the event channel. It is closed on exec so
+ * 		  that processes started by the tests don't hold the channel open.
+ */
+GTestRunnerListener::GTestRunnerListener(int fd)
+: fd(fd), current()
+{
+	fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+/*! \brief Destructor
+ *
+ * Closes the event channel, which tells the runner no more records follow.
+ */
+GTestRunnerListener::~GTestRunnerListener() {
+	close(fd);
+}
+
+/*! \brief Appends the listener to gtest's listeners if the runner started the process.
+ *
+ * \return true if the listener was installed.
+ */
+bool GTestRunnerListener::install() {
+	const char* value = getenv(GTESTRUNNER_EVENT_FD);
+	if(!value || !*value)
+		return false;
+	int fd = atoi(value);
+	if(fd <= 2 || fcntl(fd, F_GETFD) == -1)
+		return false;
+	::testing::UnitTest::GetInstance()->listeners().Append(new GTestRunnerListener(fd));
+	return true;
+}
+
+/*! \brief Reports that a test has started.
+ */
+void GTestRunnerListener::OnTestStart(const ::testing::TestInfo& testInfo) {
+	current = std::string(testInfo.test_case_name()) + "." + testInfo.name();
+	write(TEST_START_RECORD, current);
+}
+
+/*! \brief Reports the location and message of a failed assertion of the running test.
+ */
+void GTestRunnerListener::OnTestPartResult(const ::testing::TestPartResult& result) {
+	if(result.failed())
+		write(TEST_FAILURE_RECORD, current, true, 0, result.file_name(), result.line_number(), result.message());
+}
+
+/*! \brief Reports that a test has ended, with its status and running time.
+ */
+void GTestRunnerListener::OnTestEnd(const ::testing::TestInfo& testInfo) {
+	const ::testing::TestResult* result = testInfo.result();
+	write(TEST_END_RECORD, current, result->Failed(), (uint32_t)result->elapsed_time());
+	current.clear();
+}
+
+/*! \brief Writes a single record to the event channel.
+ *
+ * The record is written with a single write() so that it reaches the runner
+ * whole whenever it fits in the pipe's buffer. A message that would take the
+ * record past TEST_EVENT_RECORD_MAX_SIZE is cut short. Errors are ignored; if
+ * the runner has gone away the tests carry on regardless.
+ */
+void GTestRunnerListener::write(uint8_t type, const std::string& name, bool failed,
+								uint32_t duration, const char* file, int line, const char* message) {
+	TestEventRecord header;
+	memset(&header, 0, sizeof(header));
+	size_t fileLength = file ? strlen(file) : 0;
+	if(fileLength > 0xFFFF)
+		fileLength = 0xFFFF;
+	size_t messageLength = message ? strlen(message) : 0;
+	size_t headerLength = sizeof(header) + name.size() + fileLength;
+	if(headerLength > TEST_EVENT_RECORD_MAX_SIZE)
+		return;
+	if(messageLength > TEST_EVENT_RECORD_MAX_SIZE - headerLength)
+		messageLength = TEST_EVENT_RECORD_MAX_SIZE - headerLength;
+	header.magic = TEST_EVENT_RECORD_MAGIC;
+	header.version = TEST_EVENT_RECORD_VERSION;
+	header.type = type;
+	header.failed = failed ? 1 : 0;
+	header.fileLength = (uint16_t)fileLength;
+	header.nameLength = (uint32_t)name.size();
+	if(type == TEST_FAILURE_RECORD)
+		header.messageLength = (uint32_t)messageLength;
+	else
+		header.duration = duration;
+	header.line = line;
+
+	size_t messageOffset = headerLength;
+	std::vector<char> record(messageOffset + (type == TEST_FAILURE_RECORD ? messageLength : 0));
+	memcpy(&record[0], &header, sizeof(header));
+	if(!name.empty())
+		memcpy(&record[sizeof(header)], name.data(), name.size());
+	if(fileLength > 0)
+		memcpy(&record[sizeof(header) + name.size()], file, fileLength);
+	if(record.size() > messageOffset)
+		memcpy(&record[messageOffset], message, messageLength);
+
+	size_t written = 0;
+	while(written < record.size()) {
+		ssize_t count = ::write(fd, &record[written], record.size() - written);
+		if(count < 0 && errno == EINTR)
+			continue;
+		if(count <= 0)
+			return;
+		written += count;
+	}
+}
@@ -0,0 +1,57 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * GTestRunnerListener.h - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GTESTRUNNERLISTENER_H_
+#define GTESTRUNNERLISTENER_H_
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+/*! \brief A gtest event listener reporting progress to the runner as binary records.
+ *
+ * The runner otherwise follows a test process by scraping its console output,
+ * which breaks when tests print lines that look like gtest's own and costs
+ * a fair amount at high test rates. When this library is linked into a test
+ * executable, or loaded with LD_PRELOAD where gtest is a shared library, it
+ * installs this listener before main() runs if the process was started by
+ * the runner. The listener then writes a TestEventRecord for every test start,
+ * failed assertion and test end to the pipe the runner passed down in the
+ * GTESTRUNNER_EVENT_FD environment variable. The console output is left as it
+ * is, and the runner falls back to scraping it for executables without the
+ * listener.
+ */
+class GTestRunnerListener : public ::testing::EmptyTestEventListener {
+
+private:
+	int fd;					//!< The write end of the event channel.
+	std::string current;	//!< The name of the running test.
+
+	void write(uint8_t type, const std::string& name, bool failed = false,
+			   uint32_t duration = 0, const char* file = 0, int line = -1, const char* message = 0);
+
+public:
+	GTestRunnerListener(int fd);
+	virtual ~GTestRunnerListener();
+
+	virtual void OnTestStart(const ::testing::TestInfo& testInfo);
+	virtual void OnTestPartResult(const ::testing::TestPartResult& result);
+	virtual void OnTestEnd(const ::testing::TestInfo& testInfo);
+
+	static bool install();
+};
+
+#endif /* GTESTRUNNERLISTENER_H_ */
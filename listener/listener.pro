@@ -0,0 +1,15 @@
+TEMPLATE = lib
+
+CONFIG -= qt
+CONFIG += shared debug_and_release
+CONFIG(debug, debug|release) {
+	TARGET = gtestrunnerlistener-debug
+} 
+else {
+	TARGET = gtestrunnerlistener
+}
+INCLUDEPATH += ../include
+LIBS += -lgtest
+HEADERS += GTestRunnerListener.h \
+    ../include/TestEventRecord.h
+SOURCES += GTestRunnerListener.cpp
@@ -15,57 +15,12 @@
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 #include "GTest.h"
-#include "GTestResults.h"
-#include "GTestSuite.h"
 
 /*! \brief Constructor
  *
- * \param parent A pointer to the parent object. This should be a GTestSuite.
- * \param name The name of the unit test. If called directly, this should be
- * 			   the value \em testName in \code GTEST(testCase, testName) \endcode
+ * \param store The store holding the test.
+ * \param id The id of the test in the store.
  */
-GTest::GTest(QObject* parent, QString name)
-: QObject(parent), testResults(0)
-{
-	setObjectName(name);
-}
-
-/*! \brief Constructor
- *
- * This is the same as the constructor with the QObject* argument,
- * except that addTest is called on the parent.
- * \param parent A pointer to the parent test.
- * \param name The name of the unit test. If called directly, this should be
- * 			   the value \em testName in \code GTEST(testCase, testName) \endcode
- */
-GTest::GTest(GTestSuite* parent, QString name)
-: QObject(parent), testResults(0)
-{
-	setObjectName(name);
-	if(parent)
-		parent->addTest(this);
-}
-
-/*! \bried Destructor
- *
- * Deletes the testResult object if it exists.
- */
-GTest::~GTest() {
-	if(testResults)
-		delete testResults;
-}
-
-/*! \brief Receives a test result object from a GTestSuite object.
- *
- * \param testResults The test result object, or 0 if there was
- * 					  an error in processing.
- */
-void GTest::receiveTestResults(GTestResults* testResults) {
-	if(this->testResults != 0)
-		delete this->testResults;
-	this->testResults = testResults;
-	emit testResultsReady();
-}
-
-
-
+GTest::GTest(const TestStore* store, int id)
+: store(store), id(id)
+{}
@@ -15,12 +15,18 @@
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 #include "GTestExecutable.h"
-#include "GTestParser.h"
+#include "GTestFilter.h"
+#include "TestHistory.h"
+#include "TestPartitioner.h"
+#include "TestScheduler.h"
 
 #include <QDebug>
 #include <QFile>
 #include <QMessageBox>
 #include <QDateTime>
+#include <QThread>
+
+int GTestExecutable::nextJobId = 1;
 
 /*! \brief Constructor
  *
@@ -29,329 +35,787 @@
  * 		  This is validated by a getState() call.
  */
 GTestExecutable::GTestExecutable(QObject* parent, QString filePath)
-: GTestSuite(parent, filePath), state(VALID), processLock(),
-  outputLock(), gtest(0), standardOutput(), standardError(),
-  listingSet(), oldListingSet()
+: QObject(parent), state(VALID),
+  jobQueue(), currentJob(0), startPending(false), runSelection(),
+  engine(0), listingJob(0), shardJobs(), resultsJob(0), shardOutputPaths(), filterArgument(), scheduler(0),
+  shardCount(qMax(1, QThread::idealThreadCount())), jsonResults(false), runShardCount(1), history(0), runningShards(0),
+  shardExitStatus(QProcess::NormalExit), shardExitCode(0), shardFilters(),
+  shardEstimates(), shardDurations(), runTimer(),
+  predictedMakespan(0), actualMakespan(0),
+  standardOutputs(), standardErrors(), store(), testResults(0), previousResults(), keptRuns(1),
+  listingCache(0), listingIdentity(), pendingIdentity(), storeListing(false)
 {
+	setObjectName(filePath);
 	getState();
 }
 
 /*! \brief Destructor
  *
- * Deletes the process handle to the executable file.
+ * Kills any process still running for this executable and deletes the last results.
+ * The scheduler drops the shards it still has queued, and frees the slots of
+ * those running, when it is notified of the destruction.
  */
 GTestExecutable::~GTestExecutable() {
-	if(gtest)
-		delete gtest;
+	if(engine) {
+		if(listingJob)
+			QMetaObject::invokeMethod(engine, "kill", Qt::QueuedConnection, Q_ARG(int, listingJob));
+		int job;
+		foreach(job, shardJobs.keys())
+			QMetaObject::invokeMethod(engine, "kill", Qt::QueuedConnection, Q_ARG(int, job));
+	}
+	delete testResults;
+	qDeleteAll(previousResults);
+}
+
+/*! \brief Sets the engine that runs this executable's processes.
+ *
+ * The engine's signals are shared by every executable, so each one only
+ * handles the jobs it has started.
+ * \param engine The engine to use. It must be set before listing or running.
+ */
+void GTestExecutable::setEngine(TestEngine* engine) {
+	if(this->engine)
+		QObject::disconnect(this->engine, 0, this, 0);
+	this->engine = engine;
+	if(!engine)
+		return;
+	QObject::connect(engine, SIGNAL(listingFinished(int, int, int, int, TestListing, QByteArray)),
+					 this, SLOT(listingFinished(int, int, int, int, TestListing, QByteArray)));
+	QObject::connect(engine, SIGNAL(testEvents(int, QList<TestEvent>)),
+					 this, SLOT(testEvents(int, QList<TestEvent>)));
+	QObject::connect(engine, SIGNAL(jobFinished(int, int, int, int)),
+					 this, SLOT(processFinished(int, int, int, int)));
+	QObject::connect(engine, SIGNAL(resultsParsed(int, GTestExecutableResults*)),
+					 this, SLOT(resultsParsed(int, GTestExecutableResults*)));
+}
+
+/*! \brief Queues a job on this executable.
+ *
+ * Jobs are worked on one at a time, in the order they were queued. A job
+ * is never started from within this call, so that the caller can keep the
+ * returned id before any signal about the job is sent.
+ * \param type What the job does.
+ * \return The id of the job, or 0 if the executable can't be run.
+ */
+int GTestExecutable::enqueue(JOB type) {
+	if(getState() != VALID || !engine)
+		return 0; //! \todo throw error here?
+	QueuedJob job = { nextJobId++, type };
+	jobQueue.append(job);
+	scheduleNextJob();
+	return job.id;
+}
+
+/*! \brief Queues a call to startNextJob() if one isn't already pending.
+ */
+void GTestExecutable::scheduleNextJob() {
+	if(startPending || currentJob || jobQueue.isEmpty())
+		return;
+	startPending = true;
+	QMetaObject::invokeMethod(this, "startNextJob", Qt::QueuedConnection);
+}
+
+/*! \brief Starts the job at the head of the queue, if no job is being worked on.
+ *
+ * The selection of a run is taken from the store as the run starts, so a
+ * run queued behind another one runs the tests selected by then.
+ */
+void GTestExecutable::startNextJob() {
+	startPending = false;
+	if(currentJob || jobQueue.isEmpty())
+		return;
+	QueuedJob job = jobQueue.takeFirst();
+	currentJob = job.id;
+	switch(job.type) {
+	case LIST:
+		startListing();
+		break;
+	case RUN:
+		startRun(selectedTests());
+		break;
+	case RERUN:
+		startRun(failedTests());
+		break;
+	}
+}
+
+/*! \brief Ends the current job and moves on to the next one in the queue.
+ */
+void GTestExecutable::finishJob() {
+	int job = currentJob;
+	currentJob = 0;
+	emit jobFinished(this, job);
+	scheduleNextJob();
+}
+
+/*! \brief Cancels a job that hasn't been started yet.
+ *
+ * jobCancelled() is sent for the job. A job that has already started can
+ * only be stopped with Kill().
+ * \param job The id returned when the job was queued.
+ * \return true if the job was cancelled, false if it isn't queued.
+ */
+bool GTestExecutable::cancel(int job) {
+	for(int i = 0; i < jobQueue.size(); ++i) {
+		if(jobQueue.at(i).id == job) {
+			jobQueue.removeAt(i);
+			emit jobCancelled(this, job);
+			return true;
+		}
+	}
+	return false;
+}
+
+/*! \brief Queues a listing of the unit tests available from this executable.
+ *
+ * The listing is produced once every job queued before it has finished.
+ * \see GTestExecutable::startListing()
+ * \return The id of the job, or 0 if the executable can't be run.
+ */
+int GTestExecutable::produceListing() {
+	return enqueue(LIST);
+}
+
+/*! \brief Queues a run of the tests checked in the store.
+ *
+ * \see GTestExecutable::startRun()
+ * \return The id of the job, or 0 if no test is checked or the executable
+ * 		   can't be run. Otherwise testsFinished() is emitted when the run
+ * 		   ends, unless no test is checked by the time it starts.
+ */
+int GTestExecutable::runTest() {
+	if(selectedTests().isEmpty())
+		return 0;
+	return enqueue(RUN);
+}
+
+/*! \brief Queues a run of the tests that failed in the last run.
+ *
+ * \see GTestExecutable::startRun()
+ * \return The id of the job, or 0 if no test has failed or the executable
+ * 		   can't be run.
+ */
+int GTestExecutable::rerunFailedTests() {
+	if(failedTests().isEmpty())
+		return 0;
+	return enqueue(RERUN);
 }
 
-/*! \brief Produces a listing of the unit tests available from this executable.
+/*! \brief Starts producing a listing of the unit tests available from this executable.
  *
  * The function produces a listing of all unit tests provided by the executable
- * located at the filePath 'name'. Since QProcess allows us to execute the
- * executable in another thread, we have an asynchronous return the this object.
- * This allows the runner to continue calling produceListing() on other
- * GTestExecutable objects while the QProcess retrieves the result.
+ * located at the filePath 'name'. The process is run and its output parsed
+ * by the engine's thread, so we have an asynchronous return to this object.
+ * This allows the runner to continue listing other GTestExecutable objects
+ * while the QProcess retrieves the result.
  * A caller can determine when the listing is ready by connecting a slot to
  * the listingReady() slot.
+ * If a listing cache is set, an executable that hasn't changed since it was
+ * last listed isn't run at all. If its listing is already loaded nothing is
+ * done, otherwise the cached listing is parsed in place of the process output.
  */
-void GTestExecutable::produceListing() {
-	//We lock so that any attempt to try to produce a listing
-	//or run a test will block until we're done with what we're
-	//doing here.
-	if(getState() != VALID)
-		return; //! \todo throw error here?
-	//! \todo Check if the gtest file has changed, and preempt here if unchanged.
-
-    setUpExecutable();
+void GTestExecutable::startListing() {
+	storeListing = false;
+	if(listingCache) {
+		pendingIdentity = listingCache->identify(objectName());
+		if(store.getSuiteCount() > 0 && pendingIdentity == listingIdentity) {
+			finishJob(); //the listing we hold is still current
+			return;
+		}
+		QByteArray listing;
+		if(listingCache->lookup(objectName(), pendingIdentity, &listing)) {
+			listingJob = TestEngine::createJobId();
+			QMetaObject::invokeMethod(engine, "parseListing", Qt::QueuedConnection,
+									  Q_ARG(int, listingJob), Q_ARG(QByteArray, listing));
+			return;
+		}
+		storeListing = true;
+	}
 
-    QObject::connect(gtest, SIGNAL(finished(int, QProcess::ExitStatus)),
-                     this, SLOT(finishedListing(int, QProcess::ExitStatus)));
-	QObject::connect(gtest, SIGNAL(finished(int, QProcess::ExitStatus)),
-					 this, SLOT(parseListing(int, QProcess::ExitStatus)));
-	gtest->start(objectName(), QStringList() << "--gtest_list_tests");
-	//unlock the processLock in the parseListing slot
+	listingJob = TestEngine::createJobId();
+	QMetaObject::invokeMethod(engine, "startListing", Qt::QueuedConnection,
+							  Q_ARG(int, listingJob), Q_ARG(QString, objectName()));
 }
 
-/*! \brief Parses the listing once the QProcess has exited.
+/*! \brief Applies a listing once the engine has produced and parsed it.
  *
- * This function is called after the QProcess emits its finished() signal.
+ * This slot is called when the engine emits its listingFinished() signal.
  * It first checks the exit status and if everything has gone smoothly, it
- * processes the stdout buffer that was filled by the gtest executable.
- * It breaks the buffer into lines which is then understood by the GTestRunner.
- *
- * \todo TODO::Have this function create the GTest / GTestSuite tree instead of the test runner
+ * adds the parsed suites and tests to the store. Suites and tests missing
+ * from the new listing are removed from the store, and those that are new
+ * are appended to it.
+ * \see TestStore::beginListing()
+ * \see TestEngine::parseListingOutput()
  */
-void GTestExecutable::parseListing(int /*exitCode*/, QProcess::ExitStatus exitStatus) {
+void GTestExecutable::listingFinished(int job, int exitCode, int exitStatus, int error, TestListing listing, QByteArray output) {
+	if(job != listingJob)
+		return;
+	listingJob = 0;
+	//just record the exit status/code for reference.
+	this->error = (QProcess::ProcessError)error;
+	this->exitStatus = (QProcess::ExitStatus)exitStatus;
+	this->exitCode = exitCode;
 	//Check status
 	if(exitStatus != QProcess::NormalExit) {
+		//The listing we hold may be stale, so the next refresh lists again.
+		listingIdentity = ExecutableIdentity();
 		QMessageBox::warning((QWidget*)this->parent(),"Error Retrieving Listing",
 				"The Google test executable exited abnormally.");
-		processLock.unlock();
+		finishJob();
 		return;
 	}
-	//Status is good, set up some vars and let's start parsing
-	oldListingSet = listingSet; //copy old set, to find elements to remove
-	QString name;
-	QString line;
-    GTestSuite* testSuite = 0;
-	GTest* test;
-	standardOutput.open(QBuffer::ReadOnly);
-	while(standardOutput.canReadLine()) {
-		line = standardOutput.readLine();
-        name = line.trimmed();	//remove  front and back white characters.
-        if(name.endsWith('.')) {	//this means its a test suite name
-            name.chop(1);	//get the name without the '.'
-			testSuite = findChild<GTestSuite*>(name);
-			if(!testSuite)	//if it doesn't already exist, make one
-				testSuite = new GTestSuite(this, name);
-			listingSet << name;	//add it to our new listing set
-		}
-		else {
-            //We should always run into 'testsuitename.'
-            //before we hit a unit test name.
-            Q_ASSERT(testSuite != 0);
-
-            //Parametrized test have a comment that start with #
-            //We remove it here, only the name will be in the result XML.
-            int indexOf = name.indexOf("#");
-            if(0 < indexOf)
-            {
-                name.truncate(indexOf);
-                name = name.trimmed();
-            }
-
-			test = testSuite->findChild<GTest*>(name);
-			if(!test)	//if it doesn't already exist, make one
-				test = new GTest(testSuite, name);
-			//add it to our new listingSet in form of 'testsuitename.testname"
-			listingSet << testSuite->objectName().append('.').append(name);
+	//A failed listing is reported by the runner; keep the listing we have.
+	if(exitCode == 0) {
+		store.beginListing();
+		for(int i = 0; i < listing.size(); ++i) {
+			int suite = store.addSuite(listing.at(i).first);
+			const QStringList& tests = listing.at(i).second;
+			for(int j = 0; j < tests.size(); ++j)
+				store.addTest(suite, tests.at(j));
 		}
+		store.endListing();
 	}
-	//diff our old set with our new set to find removed tests.
-	QSet<QString> diffedListing = oldListingSet - listingSet;
-	QStringList deletedSuites;
-	QSet<QString>::iterator it = diffedListing.begin();
-	while(it != diffedListing.end()) {
-		int indexOfDot = it->indexOf('.');
-		if(indexOfDot == -1) { //not in form of testsuitename.testname
-			//must be an entire suite to be removed.
-			testSuite = findChild<GTestSuite*>(*it);
-			Q_ASSERT(testSuite != 0);
-			deletedSuites << testSuite->objectName();
-			testSuite->deleteLater(); //deletes children and cleans up signals/slots
-			continue;
+
+	//Only a successful listing is current for the build it was produced by.
+	if(listingCache) {
+		if(exitCode == 0) {
+			listingIdentity = pendingIdentity;
+			if(storeListing)
+				listingCache->store(objectName(), listingIdentity, output);
 		}
-		//its of the form "testsuitename.testname"
-		//check if we've deleted the suite already
-		name = it->left(indexOfDot);
-		if(deletedSuites.contains(name))
-			continue; // already handled the deletion
-		testSuite = findChild<GTestSuite*>(name);
-		Q_ASSERT(testSuite != 0);
-		test = findChild<GTest*>(it->right(it->length()-indexOfDot));
-		Q_ASSERT(test != 0);
-		test->deleteLater();
-		++it;
+		else
+			listingIdentity = ExecutableIdentity();
 	}
-
-	standardOutput.close();
-	processLock.unlock();
 	//! \todo Only emit listingReady if it differs from the last listing.
 	emit listingReady(this);
+	finishJob();
 }
 
-/*! \brief Launches a QProcess to run the gtest executable
- *
- * This creates a process and runs it based on the 'name' instance
- * variable which represents the filepath of the executable.
+/*! \brief Launches the QProcesses to run the gtest executable
  *
- * \todo TODO::Check the state before running the test.
+ * This prepares a run of the executable based on the 'name' instance
+ * variable which represents the filepath of the executable. The run is
+ * split into at most shardCount processes (and never more than there are
+ * tests to run), each writing its own .xml file. If the durations of the
+ * executable's tests are known, each shard is given a --gtest_filter of
+ * tests balanced by duration. Otherwise each shard is given its
+ * GTEST_SHARD_INDEX so that gtest runs only its round-robin share of the
+ * filtered tests.
+ * The shards are queued on the scheduler, with their
+ * estimated durations, if one is set. Otherwise they are all started
+ * immediately. The results are merged once every shard has finished.
+ * \see GTestExecutable::partitionShards()
+ * \see GTestExecutable::launchShard()
+ * \see GTestExecutable::processFinished()
+ * \param selected The tests to run, in listing order. If there are none
+ * 		  the job ends without running anything.
  */
-void GTestExecutable::runTest() {
-	//Check our state, and whether we're listening to run signals.
-	if(this->state != VALID || this->runList.isEmpty())
+void GTestExecutable::startRun(const QStringList& selected) {
+	if(selected.isEmpty()) {
+		finishJob();
 		return;
+	}
+	runSelection = selected;
+	error = QProcess::UnknownError;
 
-    setUpExecutable();
-
-    QObject::connect(gtest, SIGNAL(finished(int, QProcess::ExitStatus)),
-                     this, SLOT(finishedTesting(int, QProcess::ExitStatus)));
-
-    QString filterString = "--gtest_filter=";
-	QString string;
-	foreach(string, testFilter){
-		filterString.append(string).append(":");
-    }
-	filterString.chop(1);
+	//Collapse the selection so the argument stays small however many tests are selected.
+	QString pattern = listingFilter().compile(selected);
+	filterArgument = pattern.isEmpty() ? QString() : "--gtest_filter=" + pattern;
 
     // Compose the output file name from the executable name and a timestamp.
     QFileInfo fi(objectName());
-    m_OutputFilePath = m_ResultsPath;
-    m_OutputFilePath.append("test_details-");
-    m_OutputFilePath.append(fi.baseName());
-    m_OutputFilePath.append( QDateTime::currentDateTime().toString("'-'yyyy_MM_dd-HH_mm_ss"));
-    m_OutputFilePath.append(".xml");
+    QString outputBase = m_ResultsPath;
+    outputBase.append("test_details-");
+    outputBase.append(fi.baseName());
+    outputBase.append( QDateTime::currentDateTime().toString("'-'yyyy_MM_dd-HH_mm_ss"));
+    QString suffix = jsonResults ? ".json" : ".xml";
+    m_OutputFilePath = outputBase + suffix;
+
+	runShardCount = qBound(1, selected.size(), shardCount);
+	runningShards = runShardCount;
+	shardExitStatus = QProcess::NormalExit;
+	shardExitCode = 0;
+	shardOutputPaths.clear();
+	shardDurations.clear();
+	standardOutputs.clear();
+	standardErrors.clear();
+	OutputRange noOutput = { -1, 0, 0 };
+	testOutputs.fill(noOutput, store.getTestIdCount());
+	if(testResults)
+		previousResults.prepend(testResults);
+	setKeptRuns(keptRuns);
+	testResults = new GTestExecutableResults();
+	testResults->addAttribute("name", "AllTests");
+	testResults->addAttribute("tests", "0");
+	testResults->addAttribute("failures", "0");
+	for(int shardIndex = 0; shardIndex < runShardCount; ++shardIndex) {
+		standardOutputs << OutputCapturePointer(new OutputCapture());
+		standardErrors << OutputCapturePointer(new OutputCapture());
+		if(runShardCount > 1)
+			shardOutputPaths << QString("%1-shard%2%3").arg(outputBase).arg(shardIndex).arg(suffix);
+		else
+			shardOutputPaths << m_OutputFilePath;
+		shardDurations << 0;
+	}
+	partitionShards();
+	runTimer.start();
+
+	if(scheduler) {
+		scheduler->submit(this, shardEstimates);
+		return;
+	}
+	for(int shardIndex = 0; shardIndex < runShardCount; ++shardIndex)
+		launchShard(shardIndex);
+}
+
+/*! \brief Starts the process for a single shard of the current run.
+ *
+ * This is called by startRun(), or by the scheduler when it has a free
+ * process slot for the shard. The process is started by the engine.
+ * \param shardIndex The index of the shard of the current run.
+ */
+void GTestExecutable::launchShard(int shardIndex) {
+	QString filter = filterArgument;
+	QStringList environment;
+	if(!shardFilters.isEmpty()) {
+		filter = shardFilters.at(shardIndex);
+	}
+	else if(runShardCount > 1) {
+		environment << "GTEST_TOTAL_SHARDS=" + QString::number(runShardCount);
+		environment << "GTEST_SHARD_INDEX=" + QString::number(shardIndex);
+	}
+	int job = TestEngine::createJobId();
+	shardJobs.insert(job, shardIndex);
+	shardDurations[shardIndex] = -runTimer.elapsed() / 1000.0;
 
 	QStringList commandLineParameters;
-    commandLineParameters << "--gtest_output=xml:" + m_OutputFilePath;
-	commandLineParameters << filterString;
+	commandLineParameters << (jsonResults ? "--gtest_output=json:" : "--gtest_output=xml:") + shardOutputPaths.at(shardIndex);
+	if(!filter.isEmpty())
+		commandLineParameters << filter;
+	QMetaObject::invokeMethod(engine, "startTests", Qt::QueuedConnection,
+							  Q_ARG(int, job), Q_ARG(QString, objectName()),
+							  Q_ARG(QStringList, commandLineParameters), Q_ARG(QStringList, environment),
+							  Q_ARG(OutputCapturePointer, standardOutputs.at(shardIndex)),
+							  Q_ARG(OutputCapturePointer, standardErrors.at(shardIndex)));
+}
 
-	//! \todo Only run tests in the runList.
-	gtest->start(objectName(), commandLineParameters);
+/*! \brief Retrieves the tests checked in the store, in listing order.
+ *
+ * \return The selected tests in the form "suite.test".
+ */
+QStringList GTestExecutable::selectedTests() const {
+	QStringList selected;
+	for(int row = 0; row < getSuiteCount(); ++row) {
+		GTestSuite suite = getSuite(row);
+		if(suite.getCheckState() == Qt::Unchecked)
+			continue;
+		for(int i = 0, count = suite.getTestCount(); i < count; ++i) {
+			GTest test = suite.getTest(i);
+			if(test.getCheckState() == Qt::Checked)
+				selected << test.getFullName();
+		}
+	}
+	return selected;
 }
 
-/*! \brief Parses the test results .xml file produced by the QProcess.
+/*! \brief Retrieves the tests that failed in the last run, in listing order.
  *
- * This function opens the .xml file produced by the gtest process and parses
- * its contents. It uses the GTestParser
+ * \return The failed tests in the form "suite.test".
  */
-void GTestExecutable::finishedTesting(int exitCode, QProcess::ExitStatus exitStatus) {
-	QObject::disconnect(gtest, SIGNAL(finished(int, QProcess::ExitStatus)),
-                        this, SLOT(finishedTesting(int, QProcess::ExitStatus)));
-    processLock.unlock();
+QStringList GTestExecutable::failedTests() const {
+	QStringList failed;
+	for(int row = 0; row < getSuiteCount(); ++row) {
+		GTestSuite suite = getSuite(row);
+		if(suite.getStatus() != TestStore::FAILED)
+			continue;
+		for(int i = 0, count = suite.getTestCount(); i < count; ++i) {
+			GTest test = suite.getTest(i);
+			if(test.getStatus() == TestStore::FAILED)
+				failed << test.getFullName();
+		}
+	}
+	return failed;
+}
+
+/*! \brief Retrieves the tests of the current run in the order gtest runs them.
+ *
+ * gtest runs the tests in the order they are listed, skipping those that
+ * are disabled. This order is what it uses to assign tests to shards.
+ * \return The tests of the run in the form "suite.test".
+ */
+QStringList GTestExecutable::orderedRunTests() const {
+	QStringList ordered;
+	QString test;
+	foreach(test, runSelection) {
+		if(!test.startsWith("DISABLED_") && !test.section('.', 1).startsWith("DISABLED_"))
+			ordered << test;
+	}
+	return ordered;
+}
+
+/*! \brief Creates a filter compiler for the executable's current listing.
+ *
+ * \see GTestFilter
+ */
+GTestFilter GTestExecutable::listingFilter() const {
+	GTestFilter filter;
+	for(int row = 0; row < getSuiteCount(); ++row) {
+		GTestSuite suite = getSuite(row);
+		filter.addSuite(suite.getName(), suite.getTestNames());
+	}
+	return filter;
+}
+
+/*! \brief Estimates the running time of each shard when gtest does the sharding.
+ *
+ * gtest assigns the i'th test it runs to shard i modulo the shard count, so
+ * each shard is estimated by the sum of the recorded durations of its tests.
+ * \see TestHistory::estimate()
+ * \return The estimated running time of each shard, in seconds.
+ */
+QList<double> GTestExecutable::estimateShards() const {
+	QList<double> estimates;
+	for(int i = 0; i < runShardCount; ++i)
+		estimates << 0;
+	QStringList tests = orderedRunTests();
+	for(int i = 0; i < tests.size(); ++i)
+		estimates[i % runShardCount] += history ? history->estimate(objectName(), tests.at(i)) : 1;
+	return estimates;
+}
+
+/*! \brief Decides which tests each shard of the current run is given.
+ *
+ * When the executable has a duration history and the run has more than one
+ * shard, the tests are bin-packed by duration into shards of nearly equal
+ * running time, and each shard is later given its own --gtest_filter.
+ * Otherwise the run falls back to gtest's round-robin sharding.
+ * \see TestPartitioner
+ */
+void GTestExecutable::partitionShards() {
+	shardFilters.clear();
+	if(runShardCount < 2 || !history || !history->hasHistory(objectName())) {
+		shardEstimates = estimateShards();
+		return;
+	}
+	TestPartitioner partitioner(runShardCount);
+	QString test;
+	foreach(test, orderedRunTests())
+		partitioner.addTest(test, history->estimate(objectName(), test));
+	partitioner.partition();
+	//The negative form would also match tests listed after this run
+	//started, which would then run in every shard.
+	GTestFilter filter = listingFilter();
+	for(int i = 0; i < runShardCount; ++i) {
+		//An empty --gtest_filter= would run nothing, rather than every test.
+		QString pattern = filter.compile(partitioner.getTests(i), false);
+		shardFilters << (pattern.isEmpty() ? QString() : "--gtest_filter=" + pattern);
+	}
+	shardEstimates = partitioner.getEstimates();
+}
+
+/*! \brief Slot to be called when a single shard of a test run has finished.
+ *
+ * This records the worst exit status of the shards and, once the last
+ * shard has exited, hands over to finishedTesting() with the combined status.
+ */
+void GTestExecutable::processFinished(int job, int exitCode, int exitStatus, int error) {
+	if(!shardJobs.contains(job))
+		return;
+	int shardIndex = shardJobs.take(job);
+	if(error != QProcess::UnknownError && this->error == QProcess::UnknownError)
+		this->error = (QProcess::ProcessError)error;
 	if(exitStatus != QProcess::NormalExit)
+		shardExitStatus = (QProcess::ExitStatus)exitStatus;
+	if(exitCode != 0 && shardExitCode == 0)
+		shardExitCode = exitCode;
+	shardDurations[shardIndex] += runTimer.elapsed() / 1000.0;
+	emit shardFinished();
+	if(--runningShards > 0)
+		return;
+	finishedTesting(shardExitCode, shardExitStatus);
+}
+
+/*! \brief Has the engine parse the test result files produced by the shards.
+ *
+ * This is called once every shard of the run has finished. The engine
+ * parses the .xml or .json file of each shard and merges the
+ * per shard results into a single GTestExecutableResults tree, which is
+ * handed back to resultsParsed(). An aborted run isn't parsed, but keeps
+ * the results built while it ran.
+ * testsFinished() is emitted whether or not the run produced results.
+ */
+void GTestExecutable::finishedTesting(int exitCode, QProcess::ExitStatus exitStatus) {
+	this->exitStatus = exitStatus;
+	this->exitCode = exitCode;
+	predictedMakespan = 0;
+	actualMakespan = 0;
+	if(exitStatus != QProcess::NormalExit) {
+		emit testsFinished(this);
+		finishJob();
 		return;
-    QFile xmlFile(m_OutputFilePath);
-    GTestParser parser(&xmlFile);
-	GTestExecutableResults* testResults = parser.parse();
-	this->testResults = testResults;
-
-    foreach(GTest* it , runList) {
-        GTestResults* testSuiteResults = testResults->getTestResults(it->objectName());
-        if(testSuiteResults){
-            it->receiveTestResults(testSuiteResults);
-        }
 	}
-	runList.clear();
-    cleanupExecutable(exitCode, exitStatus);
-	emit testResultsReady();
-}
-
-/*! \brief Slot that is called when stdout data is available from the process.
+
+	for(int i = 0; i < shardEstimates.size() && i < shardDurations.size(); ++i) {
+		predictedMakespan = qMax(predictedMakespan, shardEstimates.at(i));
+		actualMakespan = qMax(actualMakespan, shardDurations.at(i));
+	}
+
+	resultsJob = TestEngine::createJobId();
+	QMetaObject::invokeMethod(engine, "parseResults", Qt::QueuedConnection,
+							  Q_ARG(int, resultsJob), Q_ARG(QStringList, shardOutputPaths));
+}
+
+/*! \brief Slot to be called when the engine has parsed the results of the current run.
  *
- * This function sets up the executable reader function using a lock so that
- * data isn't attempted to be read from both standard output and standard
- * error simultaneously (which currently isn't supported by the QProcess
- * class).
- * \see GTestExecutable::readExecutableOutput()
+ * \param job The engine job that parsed the results.
+ * \param testResults The merged results of every shard, or null if none
+ * 		  could be parsed. This object takes ownership of them.
  */
-void GTestExecutable::standardOutputAvailable() {
-	outputLock.lock();
-	gtest->setReadChannel(QProcess::StandardOutput);
-	readExecutableOutput(standardOutput);
-	outputLock.unlock();
+void GTestExecutable::resultsParsed(int job, GTestExecutableResults* testResults) {
+	if(job != resultsJob) {
+		delete testResults;
+		return;
+	}
+	resultsJob = 0;
+	if(testResults) {
+		if(history)
+			history->recordResults(objectName(), testResults);
+		receiveTestResults(testResults);
+	}
+	emit testsFinished(this);
+	finishJob();
 }
-
-/*! \brief Slot that is called when stderr data is available from the process.
+
+/*! \brief Takes ownership of the results of a run and updates the test statuses from them.
  *
- * This function sets up the executable reader function using a lock so that
- * data isn't attempted to be read from both standard output and standard
- * error simultaneously (which currently isn't supported by the QProcess
- * class).
- * \see GTestExecutable::readExecutableOutput()
+ * The results built while the run was in progress are reconciled with
+ * them, which completes their failure messages and attributes.
+ * \param testResults The merged results of every shard of the run.
  */
-void GTestExecutable::standardErrorAvailable() {
-	outputLock.lock();
-	gtest->setReadChannel(QProcess::StandardError);
-	readExecutableOutput(standardError);
-	outputLock.unlock();
+void GTestExecutable::receiveTestResults(GTestExecutableResults* testResults) {
+	if(this->testResults)
+		this->testResults->reconcile(testResults);
+	else
+		this->testResults = testResults;
+	GTestResults* result;
+	foreach(result, this->testResults->getTestResultsList()) {
+		GTestSuiteResults* suiteResults = dynamic_cast<GTestSuiteResults*>(result);
+		int suite = store.findSuite(result->getName());
+		if(!suiteResults || suite == -1)
+			continue;
+		GTestResults* testResult;
+		foreach(testResult, suiteResults->getTestResultsList()) {
+			int test = store.findTest(suite, testResult->getName());
+			if(test == -1)
+				continue;
+			if(testResult->getStatus() == GTestResults::NOTRUN)
+				store.setTestStatus(test, TestStore::NOT_RUN);
+			else if(testResult->getFailureCount() > 0)
+				store.setTestStatus(test, TestStore::FAILED);
+			else
+				store.setTestStatus(test, TestStore::PASSED);
+		}
+	}
 }
 
-/*! \brief Reads the current readChannel data into the appropriate QBuffer.
+/*! \brief Retrieves the results of a suite from the last run.
  *
- * This function is called when either standard output or standard error
- * data is available from the gtest executable process. Setup is done prior
- * to calling this function, so that the correct buffer is populated.
- * \see GTestExecutable::standardErrorAvailable()
- * \see GTestExecutable::standardOutputAvailable()
+ * \return The results, or null if the suite wasn't run.
  */
-void GTestExecutable::readExecutableOutput(QBuffer& standardChannel) {
-    // Collect evereything using QByteArray.
-	while(gtest->canReadLine()) {
-        QByteArray output = gtest->readLine();
-        standardChannel.write(output);
-        QString line = output;
-        if( line.startsWith("[ ") ){
-            qDebug() << line;
-            QString testName = line;
-            testName = testName.remove(0,13); // remove the [] and keep the test name.
-            testName = testName.split(' ').at(0);
-            testName = testName.trimmed();
-            QStringList testsplit = testName.split(".");
-            if(testsplit.size() > 1){
-                GTestSuite* testSuite = findChild<GTestSuite*>(testsplit.at(0));
-                GTest* test = testSuite->findChild<GTest*>(testsplit.at(1));
+GTestSuiteResults* GTestExecutable::getTestResults(const GTestSuite& suite) const {
+	if(!testResults || !suite.isValid())
+		return 0;
+	return dynamic_cast<GTestSuiteResults*>(testResults->getTestResults(suite.getName()));
+}
 
-                if(line.contains("[ RUN      ]")){
-                    emit BeginTest(test);
-                }
-                else if (line.contains("[       OK ]")){
-                    emit EndTest(test, true);
-                }
-                else if (line.contains("[  FAILED  ]")){
-                    emit EndTest(test, false);
-                }
-            }
-        }
-    }
+/*! \brief Retrieves the results of a test from the last run.
+ *
+ * \return The results, or null if the test wasn't run.
+ */
+GTestResults* GTestExecutable::getTestResults(const GTest& test) const {
+	if(!test.isValid())
+		return 0;
+	GTestSuiteResults* suiteResults = getTestResults(GTestSuite(&store, store.getTestSuite(test.getId())));
+	if(!suiteResults)
+		return 0;
+	return suiteResults->getTestResults(test.getName());
 }
 
-/*! \brief Slot to be called when the QProcess has finished listing the tests.
+/*! \brief Retrieves the results of a test from a run before the last.
  *
- * This function is called after a QProcess has finished generating a listing.
+ * \param test The test to look up.
+ * \param age How many runs before the last, 1 being the run before it.
+ * \return The results, or null if that run's results weren't kept or the test wasn't run.
  */
-void GTestExecutable::finishedListing(int exitCode, QProcess::ExitStatus exitStatus) {
-    QObject::disconnect(gtest, SIGNAL(finished(int, QProcess::ExitStatus)),
-                         this, SLOT(finishedListing(int, QProcess::ExitStatus)));
+GTestResults* GTestExecutable::getPreviousResults(const GTest& test, int age) const {
+	GTestExecutableResults* results = getPreviousResults(age);
+	if(!results || !test.isValid())
+		return 0;
+	GTestSuiteResults* suiteResults = dynamic_cast<GTestSuiteResults*>(results->getTestResults(store.getSuiteName(store.getTestSuite(test.getId()))));
+	if(!suiteResults)
+		return 0;
+	return suiteResults->getTestResults(test.getName());
+}
 
-    cleanupExecutable(exitCode, exitStatus);
+/*! \brief Sets the number of runs before the last whose results are kept for comparison.
+ *
+ * The results of older runs are released as soon as they are superseded,
+ * each tree at once with the arenas it was allocated from.
+ * \param keptRuns The number of runs to keep, values below 0 are clamped to 0.
+ */
+void GTestExecutable::setKeptRuns(int keptRuns) {
+	this->keptRuns = qMax(0, keptRuns);
+	while(previousResults.size() > this->keptRuns)
+		delete previousResults.takeLast();
 }
 
-/*! \brief Prepare the QProcess to be lunched.
+/*! \brief Slot that is called with the progress read from the shards of the current run.
  *
- * This function creates a QProcess and initialize stdout and sterr capture.
+ * The statuses of the tests are updated in the store and BeginTest() and
+ * EndTest() are emitted for each of them, in the order they were read.
+ * \param job The engine job of the shard.
+ * The range of each test's console output is recorded, so that it can be
+ * read back from its shard's capture without scanning the capture again,
+ * and the results of the run are built up as its tests end.
+ * \param events The tests that have begun or ended.
  */
-void GTestExecutable::setUpExecutable(){
-    //We lock so that any attempt to try to produce a listing
-    //or run a test will block until we're done with what we're
-    //doing here.
-    processLock.lock();
-    gtest = new QProcess();
+void GTestExecutable::testEvents(int job, QList<TestEvent> events) {
+	if(!shardJobs.contains(job))
+		return;
+	for(int i = 0; i < events.size(); ++i) {
+		const TestEvent& event = events.at(i);
+		int test = store.findTest(event.name);
+		if(test == -1)
+			continue;
+		updateLiveResults(test, event);
+		switch(event.type) {
+		case TestEvent::BEGIN:
+			store.setTestStatus(test, TestStore::RUNNING);
+			emit BeginTest(this, test);
+			break;
+		case TestEvent::PASSED:
+			store.setTestStatus(test, TestStore::PASSED);
+			emit EndTest(this, test, true);
+			break;
+		case TestEvent::FAILED:
+			store.setTestStatus(test, TestStore::FAILED);
+			emit EndTest(this, test, false);
+			break;
+		case TestEvent::FAILURE:
+			break;
+		case TestEvent::OUTPUT:
+			if(test < testOutputs.size()) {
+				OutputRange& output = testOutputs[test];
+				output.shard = shardJobs.value(job);
+				output.start = event.outputStart;
+				output.end = event.outputEnd;
+			}
+			break;
+		}
+	}
+}
 
-    //open buffers only once so we don't lose previously gathered data.
-    standardOutput.open(QBuffer::WriteOnly);
-    standardError.open(QBuffer::WriteOnly);
+/*! \brief Retrieves the results being built for a test of the current run, creating them if needed.
+ *
+ * \param test The test.
+ * \param suiteResults Set to the results of the test's suite.
+ */
+GTestResults* GTestExecutable::liveResults(int test, GTestSuiteResults** suiteResults) {
+	QString suiteName = store.getSuiteName(store.getTestSuite(test));
+	GTestSuiteResults* suite = dynamic_cast<GTestSuiteResults*>(testResults->getTestResults(suiteName));
+	if(!suite) {
+		suite = testResults->createSuiteResults();
+		suite->addAttribute("name", suiteName);
+		suite->addAttribute("tests", "0");
+		suite->addAttribute("failures", "0");
+		testResults->addTestResults(suite);
+	}
+	*suiteResults = suite;
+	QString testName = store.getTestName(test);
+	GTestResults* results = suite->getTestResults(testName);
+	if(!results) {
+		results = testResults->createTestResults();
+		results->addAttribute("name", testName);
+		results->addAttribute("status", "run");
+		results->addAttribute("classname", suiteName);
+		suite->addTestResults(results);
+	}
+	return results;
+}
 
-    QObject::connect(gtest, SIGNAL(readyReadStandardOutput()),
-                     this, SLOT(standardOutputAvailable()));
-    QObject::connect(gtest, SIGNAL(readyReadStandardError()),
-                     this, SLOT(standardErrorAvailable()));
+/*! \brief Adds the progress of a test to the results being built for the current run.
+ *
+ * gtest only writes its .xml file as it exits, so the results are built
+ * from the progress as it is read, with the attributes the .xml file
+ * gives them. The .xml file then only reconciles them.
+ * \see receiveTestResults()
+ */
+void GTestExecutable::updateLiveResults(int test, const TestEvent& event) {
+	if(!testResults || event.type == TestEvent::OUTPUT)
+		return;
+	GTestSuiteResults* suiteResults;
+	GTestResults* results = liveResults(test, &suiteResults);
+	if(event.type == TestEvent::FAILURE) {
+		if(event.file.isEmpty())
+			results->addFailureMessage(event.message);
+		else
+			results->addFailureMessage(QString("%1:%2\n%3").arg(event.file).arg(event.line).arg(event.message));
+	}
+	else if(event.type == TestEvent::PASSED || event.type == TestEvent::FAILED) {
+		double time = qMax(0, event.duration) / 1000.0;
+		if(event.duration >= 0)
+			results->setTime(time);
+		suiteResults->setTime(qMax(0.0, suiteResults->getTime()) + time);
+		bool failed = event.type == TestEvent::FAILED;
+		GTestResults* counted[] = { suiteResults, testResults };
+		for(int i = 0; i < 2; ++i) {
+			counted[i]->addAttribute("tests", QString::number(counted[i]->get("tests").toInt() + 1));
+			counted[i]->addAttribute("failures", QString::number(counted[i]->get("failures").toInt() + (failed ? 1 : 0)));
+		}
+	}
 }
-
-/*! \brief Slot to be called when the QProcess has finished execution.
- *
- * This function is called after a QProcess has finished either generating
- * a listing, or running the tests in the gtest executable. It populates
- * the exit statuses which can be subsequently checked by the test runner.
- * It also shutdown stdout and stderr capture.
+
+/*! \brief Retrieves the console output of a test in the last run.
+ *
+ * The output is the range recorded for the test in its shard's capture, so
+ * it is read in the same time however long the whole log is.
+ * \param test The test whose output to read.
+ * \return The lines from the test's "[ RUN      ]" line to its result
+ * 		   line, or null if the test's output wasn't found.
  */
-void GTestExecutable::cleanupExecutable(int exitCode, QProcess::ExitStatus exitStatus) {
-    QObject::disconnect(gtest, SIGNAL(readyReadStandardOutput()),
-                        this, SLOT(standardOutputAvailable()));
-    QObject::disconnect(gtest, SIGNAL(readyReadStandardError()),
-                        this, SLOT(standardErrorAvailable()));
+LogSourcePointer GTestExecutable::getTestOutput(const GTest& test) const {
+	int id = test.getId();
+	if(id < 0 || id >= testOutputs.size())
+		return LogSourcePointer();
+	const OutputRange& output = testOutputs.at(id);
+	if(output.shard < 0 || output.shard >= standardOutputs.size())
+		return LogSourcePointer();
+	return LogSourcePointer(new CaptureLogSource(standardOutputs.at(output.shard), output.start, output.end));
+}
 
-    standardOutput.close();
-    standardError.close();
-
-    //We don't do anymore processing or anything in here,
-	//just record the exit status/code for reference.
-	error = gtest->error();
-	this->exitStatus = exitStatus;
-	this->exitCode = exitCode;
-	gtest->deleteLater();
-	gtest = 0;
+/*! \brief Cancels every queued job and kills the listing process and every running shard.
+ *
+ * Shards still queued on the scheduler are cancelled. If none of the
+ * run's shards had been started, the run is finished here as aborted.
+ * The current job still finishes, as aborted.
+ */
+void GTestExecutable::Kill() {
+	while(!jobQueue.isEmpty())
+		emit jobCancelled(this, jobQueue.takeFirst().id);
+	if(listingJob)
+		QMetaObject::invokeMethod(engine, "kill", Qt::QueuedConnection, Q_ARG(int, listingJob));
+	if(scheduler && runningShards > 0) {
+		int dropped = scheduler->cancel(this);
+		if(dropped > 0) {
+			shardExitStatus = QProcess::CrashExit;
+			runningShards -= dropped;
+			if(runningShards == 0)
+				finishedTesting(shardExitCode, shardExitStatus);
+		}
+	}
+	int job;
+	foreach(job, shardJobs.keys())
+		QMetaObject::invokeMethod(engine, "kill", Qt::QueuedConnection, Q_ARG(int, job));
 }
 
 /*! \brief Retrieves the state of the executable.
@@ -370,33 +834,3 @@ GTestExecutable::STATE GTestExecutable::getState() {
 	}
 	return state;
 }
-
-/*! \brief Sets all tests in the executable to be run.
- *
- * This test should be run by right-clicking and selecting run on
- * a test suite object.
- */
-void GTestExecutable::run() {
-	//! \todo Implement this function.
-	GTestSuite::run();
-}
-
-/*! \brief A slot that receives a run request from a child GTestSuite.
- *
- * Receives a run request from a child test. Adds the test to its runlist.
- * If received by a GTestSuite, this will emit a request with its name as
- * the testCase.
- * \param testName The name of the GTest to run.
- * \param testCase The name of the GTestSuite to run. Note that
- * 				   this is 'null' if sent from a GTest, and is the
- * 				   name of the GTestSuite if received in a GTestExecutable.
- */
-void GTestExecutable::receiveRunRequest(QString testName, QString testCase) {
-	GTestSuite::receiveRunRequest(testName, testCase);
-	this->testFilter << testCase + "." + testName;
-}
-
-void GTestExecutable::resetRunState() {
-	this->runList.clear();
-	this->testFilter.clear();
-}
@@ -20,16 +20,113 @@
  * \param name The name of the test executable this result belongs to.
  */
 GTestExecutableResults::GTestExecutableResults()
-: GTestSuiteResults()
-{}
+: GTestSuiteResults(), arenas()
+{
+	arenas.append(new ResultArena());
+}
 
 /*! \brief Destructor
  *
+ * Releases every suite and test of the tree with the arenas they are in.
  */
-GTestExecutableResults::~GTestExecutableResults()
-{}
+GTestExecutableResults::~GTestExecutableResults() {
+	testResultsHash.clear();
+	qDeleteAll(arenas);
+}
 
+/*! \brief Creates the results of a suite in this tree's arena.
+ *
+ * \return The results, which the tree owns.
+ */
+GTestSuiteResults* GTestExecutableResults::createSuiteResults() {
+	return arenas.first()->create<GTestSuiteResults>();
+}
 
+/*! \brief Creates the results of a test in this tree's arena.
+ *
+ * \return The results, which the tree owns.
+ */
+GTestResults* GTestExecutableResults::createTestResults() {
+	return arenas.first()->create<GTestResults>();
+}
 
+/*! \brief Takes over the arenas of another tree, and deletes it.
+ */
+void GTestExecutableResults::adoptArenas(GTestExecutableResults* other) {
+	arenas += other->arenas;
+	other->arenas.clear();
+	delete other;
+}
 
+/*! \brief Merges the results of another shard of the same executable into this one.
+ *
+ * The suites and counters are combined as in GTestSuiteResults::merge(), except
+ * that the running time is the longest of the two as shards run concurrently.
+ * \param other The shard results to merge. This object takes ownership of it
+ * 		  and of its arenas.
+ */
+void GTestExecutableResults::merge(GTestExecutableResults* other) {
+	if(!other || other == this)
+		return;
+	double time = qMax(getTime(), other->getTime());
+	GTestSuiteResults::merge(other);
+	setTime(time);
+	adoptArenas(other);
+}
 
+/*! \brief Copies results, and those of their constituent tests, into this tree's arena.
+ *
+ * \param results The results to copy, from another tree.
+ * \return The copy, which the tree owns.
+ */
+GTestResults* GTestExecutableResults::copyResults(const GTestResults* results) {
+	const GTestSuiteResults* suite = dynamic_cast<const GTestSuiteResults*>(results);
+	if(!suite) {
+		GTestResults* copy = createTestResults();
+		*copy = *results;
+		return copy;
+	}
+	GTestSuiteResults* copy = createSuiteResults();
+	static_cast<GTestResults&>(*copy) = *suite;
+	GTestResults* child;
+	foreach(child, suite->getTestResultsList())
+		copy->addTestResults(copyResults(child));
+	return copy;
+}
+
+/*! \brief Reconciles the results of a suite of this tree with those of the same suite in another tree.
+ *
+ * The suites and tests of 'other' enrich the results of the same name in
+ * 'suite', so results already handed out stay valid. Results only found in
+ * 'other' are copied into this tree and those only found in 'suite' are kept.
+ */
+void GTestExecutableResults::reconcileSuite(GTestSuiteResults* suite, const GTestSuiteResults* other) {
+	suite->enrich(*other);
+	GTestResults* incoming;
+	foreach(incoming, other->getTestResultsList()) {
+		GTestResults* existing = suite->getTestResults(incoming->getName());
+		GTestSuiteResults* existingSuite = dynamic_cast<GTestSuiteResults*>(existing);
+		const GTestSuiteResults* incomingSuite = dynamic_cast<const GTestSuiteResults*>(incoming);
+		if(!existing)
+			suite->addTestResults(copyResults(incoming));
+		else if(existingSuite && incomingSuite)
+			reconcileSuite(existingSuite, incomingSuite);
+		else
+			existing->enrich(*incoming);
+	}
+}
+
+/*! \brief Reconciles the results built during a run with the final results of the run.
+ *
+ * The attributes and failure messages of 'other' are copied into the
+ * results of the same name here, and the results only found in 'other' are
+ * copied into this tree, so 'other' and its arenas are released as soon as
+ * the trees are reconciled rather than kept alive with this tree.
+ * \param other The final results. This object takes ownership of it.
+ */
+void GTestExecutableResults::reconcile(GTestExecutableResults* other) {
+	if(!other || other == this)
+		return;
+	reconcileSuite(this, other);
+	delete other;
+}
@@ -0,0 +1,139 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * GTestFilter.cpp - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "GTestFilter.h"
+
+/*! \brief Constructor
+ *
+ */
+GTestFilter::GTestFilter()
+: suites(), suiteTests(), suiteTestSets(), testCount(0)
+{}
+
+/*! \brief Destructor
+ *
+ */
+GTestFilter::~GTestFilter()
+{}
+
+/*! \brief Adds a suite and its tests to the listing the filter is compiled against.
+ *
+ * \param suite The name of the test suite.
+ * \param tests The names of the suite's tests.
+ */
+void GTestFilter::addSuite(const QString& suite, const QStringList& tests) {
+	if(!suiteTests.contains(suite))
+		suites << suite;
+	else
+		testCount -= suiteTestSets.value(suite).size();
+	suiteTests.insert(suite, tests);
+	//QStringList::toSet() is deprecated from Qt 5.14.
+	QSet<QString> testSet;
+	testSet.reserve(tests.size());
+	QString test;
+	foreach(test, tests)
+		testSet.insert(test);
+	suiteTestSets.insert(suite, testSet);
+	testCount += suiteTestSets.value(suite).size();
+}
+
+/*! \brief Compiles the selected tests into a --gtest_filter pattern.
+ *
+ * Selected tests that aren't part of the listing are ignored.
+ * \param selected The selected tests in the form "suite.test".
+ * \param allowNegative Whether the negative form "*-..." may be used. The negative
+ * 		  form also matches tests added to the executable since it was listed.
+ * \return The filter pattern, or an empty string if every test is selected.
+ * 		   If none of the listed tests are selected, the pattern matches nothing.
+ */
+QString GTestFilter::compile(const QStringList& selected, bool allowNegative) const {
+	QHash<QString, QSet<QString> > selectedTests;
+	int selectedCount = 0;
+	QString test;
+	foreach(test, selected) {
+		int indexOfDot = test.indexOf('.');
+		if(indexOfDot == -1)
+			continue;
+		QString suite = test.left(indexOfDot);
+		QString name = test.mid(indexOfDot + 1);
+		QHash<QString, QSet<QString> >::const_iterator listed = suiteTestSets.constFind(suite);
+		if(listed == suiteTestSets.constEnd() || !listed.value().contains(name))
+			continue;
+		QSet<QString>& tests = selectedTests[suite];
+		if(tests.contains(name))
+			continue;
+		tests.insert(name);
+		++selectedCount;
+	}
+	if(selectedCount == testCount && testCount > 0)
+		return QString();
+	if(selectedCount == 0)
+		return "-*"; //an empty filter would run everything
+
+	QString positive = compilePositive(selectedTests);
+	if(!allowNegative)
+		return positive;
+	QString negative = compileNegative(selectedTests);
+	return negative.length() < positive.length() ? negative : positive;
+}
+
+/*! \brief Compiles the selection into a list of the selected suites and tests.
+ *
+ * \param selectedTests Maps each suite to its selected tests.
+ * \return A pattern of the form "suite.*:other.test".
+ */
+QString GTestFilter::compilePositive(const QHash<QString, QSet<QString> >& selectedTests) const {
+	QStringList patterns;
+	QString suite;
+	foreach(suite, suites) {
+		const QSet<QString> tests = selectedTests.value(suite);
+		if(tests.isEmpty())
+			continue;
+		if(tests.size() == suiteTestSets.value(suite).size()) {
+			patterns << suite + ".*";
+			continue;
+		}
+		QString test;
+		foreach(test, suiteTests.value(suite))
+			if(tests.contains(test))
+				patterns << suite + "." + test;
+	}
+	return patterns.join(":");
+}
+
+/*! \brief Compiles the selection into a list of the unselected suites and tests.
+ *
+ * \param selectedTests Maps each suite to its selected tests.
+ * \return A pattern of the form "*-suite.*:other.test".
+ */
+QString GTestFilter::compileNegative(const QHash<QString, QSet<QString> >& selectedTests) const {
+	QStringList patterns;
+	QString suite;
+	foreach(suite, suites) {
+		const QSet<QString> tests = selectedTests.value(suite);
+		if(tests.size() == suiteTestSets.value(suite).size())
+			continue;
+		if(tests.isEmpty()) {
+			patterns << suite + ".*";
+			continue;
+		}
+		QString test;
+		foreach(test, suiteTests.value(suite))
+			if(!tests.contains(test))
+				patterns << suite + "." + test;
+	}
+	return "*-" + patterns.join(":");
+}
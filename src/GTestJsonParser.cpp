@@ -0,0 +1,127 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * GTestJsonParser.cpp - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <QDebug>
+#include <QHash>
+#include <QVector>
+
+#include "GTestJsonParser.h"
+#include "JsonStreamReader.h"
+
+/*! \brief Constructor
+ * \param inStream The data stream the represents the gtest .json file source.
+ */
+GTestJsonParser::GTestJsonParser(QIODevice* inStream)
+: jsonSource(inStream)
+{}
+
+/*! \brief Parses the .json file given to the constructor.
+ *
+ * The objects of the file are recognised by where they are: the run's
+ * object holds its suites in "testsuites", each suite holds its tests in
+ * "testsuite" and each test holds its failures in "failures". The scalar
+ * members of the run, suites and tests become their attributes, and the
+ * "failure" member of each failure a failure message. Anything else is
+ * skipped.
+ * \return The tree of unit test results, or null if the file holds none.
+ * 		   If the file is malformed, the results read up to that point.
+ */
+GTestExecutableResults* GTestJsonParser::parse() {
+	jsonSource->open(QIODevice::ReadOnly);
+	jsonSource->seek(0);
+	JsonStreamReader reader(jsonSource);
+	GTestExecutableResults* testExeResults = 0;
+	GTestSuiteResults* testSuiteResults = 0;
+	GTestResults* testResults = 0;
+	QVector<FRAME> frames;
+	//The same few names recur for every test, so each is only converted once.
+	QHash<QByteArray, QString> names;
+	QString name;
+	for(;;) {
+		JsonStreamReader::TOKEN token = reader.readNext();
+		FRAME frame = frames.isEmpty() ? OTHER : frames.last();
+		switch(token) {
+		case JsonStreamReader::NAME: {
+			QHash<QByteArray, QString>::const_iterator it = names.constFind(reader.getText());
+			if(it == names.constEnd())
+				it = names.insert(reader.getText(), QString::fromUtf8(reader.getText()));
+			name = it.value();
+			break;
+		}
+		case JsonStreamReader::BEGIN_OBJECT:
+			if(frames.isEmpty() && !testExeResults) {
+				testExeResults = new GTestExecutableResults();
+				frames.append(EXECUTABLE);
+			} else if(frame == SUITES) {
+				testSuiteResults = testExeResults->createSuiteResults();
+				frames.append(SUITE);
+			} else if(frame == TESTS) {
+				testResults = testExeResults->createTestResults();
+				frames.append(TEST);
+			} else {
+				frames.append(frame == FAILURES ? FAILURE : OTHER);
+			}
+			break;
+		case JsonStreamReader::BEGIN_ARRAY:
+			if(frame == EXECUTABLE && name == QLatin1String("testsuites"))
+				frames.append(SUITES);
+			else if(frame == SUITE && name == QLatin1String("testsuite"))
+				frames.append(TESTS);
+			else if(frame == TEST && name == QLatin1String("failures"))
+				frames.append(FAILURES);
+			else
+				frames.append(OTHER);
+			break;
+		case JsonStreamReader::END_OBJECT:
+		case JsonStreamReader::END_ARRAY:
+			//Suites and tests are added once their names are known.
+			if(frame == TEST && testSuiteResults) {
+				testSuiteResults->addTestResults(testResults);
+				testResults = 0;
+			} else if(frame == SUITE) {
+				testExeResults->addTestResults(testSuiteResults);
+				testSuiteResults = 0;
+			}
+			frames.pop_back();
+			break;
+		case JsonStreamReader::STRING:
+		case JsonStreamReader::NUMBER:
+		case JsonStreamReader::LITERAL: {
+			GTestResults* target = frame == EXECUTABLE ? testExeResults
+								 : frame == SUITE ? testSuiteResults
+								 : frame == TEST ? testResults : 0;
+			if(target) {
+				QString value = QString::fromUtf8(reader.getText());
+				//The .xml file gives times in seconds without a unit and statuses in lower case.
+				if(name == QLatin1String("time") && value.endsWith('s'))
+					value.chop(1);
+				else if(name == QLatin1String("status") || name == QLatin1String("result"))
+					value = value.toLower();
+				target->addAttribute(name, value);
+			} else if(frame == FAILURE && name == QLatin1String("failure")) {
+				testResults->addFailureMessage(QString::fromUtf8(reader.getText()));
+			}
+			break;
+		}
+		case JsonStreamReader::INVALID:
+			qDebug() << "Malformed gtest .json results";
+			//fall through
+		default:
+			//Results that weren't added are released with the tree's arena.
+			return testExeResults;
+		}
+	}
+}
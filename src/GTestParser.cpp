@@ -60,14 +60,14 @@ GTestExecutableResults* GTestParser::parse() {
 	xmlSource->open(QIODevice::ReadOnly);
 	xmlSource->seek(0);
 	QXmlStreamReader xmlStream(xmlSource);
-	GTestExecutableResults* testExeResults;
-	GTestSuiteResults* testSuiteResults;
+	GTestExecutableResults* testExeResults = 0;
+	GTestSuiteResults* testSuiteResults = 0;
 	GTestResults* testResults;
 	//! \bug \todo Fix the bug in here causing "premature end-of-file" error.
 	while(!xmlStream.atEnd()) {
 		while(!xmlStream.readNextStartElement() && !xmlStream.hasError() && !xmlStream.atEnd()) { qDebug() << xmlStream.name(); }
 		if(xmlStream.name() == "testcase") {
-			testResults = new GTestResults();
+			testResults = testExeResults->createTestResults();
             parseAttributes(testResults, xmlStream.attributes());
 			xmlStream.readNext();
 			while(xmlStream.name() != "testcase") { //no closing </testcase> yet
@@ -78,7 +78,7 @@ GTestExecutableResults* GTestParser::parse() {
 			testSuiteResults->addTestResults(testResults);
 		}
         else if(xmlStream.name() == "testsuite") {
-            testSuiteResults = new GTestSuiteResults();
+            testSuiteResults = testExeResults->createSuiteResults();
             parseAttributes(testSuiteResults, xmlStream.attributes());
             testExeResults->addTestResults(testSuiteResults);
         }
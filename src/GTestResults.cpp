@@ -16,13 +16,24 @@
 
 #include "GTestResults.h"
 
+#include <QDateTime>
+
+const char* const GTestResults::stringAttributeNames[STRING_ATTRIBUTE_COUNT] = {
+	"name", "classname", "result", "file"
+};
+QReadWriteLock GTestResults::internLock;
+QVector<QString> GTestResults::internedStrings;
+QHash<QString, int> GTestResults::internedIds;
+
 /*! \brief Constructor
  *
- * \param name The name of the unit test to which this object belongs.
  */
 GTestResults::GTestResults()
-: failureMessages()
-{}
+: line(-1), time(-1), timestamp(0), timestampFormat(NO_TIMESTAMP), status(NO_STATUS), failureMessages(), failureLineCounts(), otherAttributes()
+{
+	for(int i = 0; i < STRING_ATTRIBUTE_COUNT; ++i)
+		strings[i] = -1;
+}
 
 /*! \brief Destructor
  *
@@ -30,14 +41,225 @@ GTestResults::GTestResults()
 GTestResults::~GTestResults()
 {}
 
+/*! \brief Retrieves the id of a string, interning it if it is new.
+ *
+ * The interned strings are kept for the life of the program, so that the
+ * names of tests are shared by the results of every run.
+ */
+int GTestResults::intern(const QString& string) {
+	{
+		QReadLocker locker(&internLock);
+		QHash<QString, int>::const_iterator it = internedIds.constFind(string);
+		if(it != internedIds.constEnd())
+			return it.value();
+	}
+	QWriteLocker locker(&internLock);
+	QHash<QString, int>::const_iterator it = internedIds.constFind(string);
+	if(it != internedIds.constEnd())
+		return it.value();
+	int id = internedStrings.size();
+	internedStrings.append(string);
+	internedIds.insert(string, id);
+	return id;
+}
+
+/*! \brief Retrieves an interned string.
+ *
+ * \param id The id of the string, or -1.
+ * \return The string, or an empty string for -1.
+ */
+QString GTestResults::internedString(int id) {
+	if(id < 0)
+		return QString();
+	QReadLocker locker(&internLock);
+	return internedStrings.at(id);
+}
 
-QString GTestResults::serialiseAttributes(){
+/*! \brief Parses a timestamp as gtest writes it.
+ *
+ * gtest writes "yyyy-MM-ddTHH:mm:ss", in its newer versions with a ".zzz"
+ * fraction, and in its JSON output with a "Z" suffix. The fields are read
+ * as UTC whatever the zone, so the timestamp reads back exactly as written.
+ * \param value The timestamp attribute.
+ * \param milliseconds Receives the timestamp in milliseconds since the epoch.
+ * \param format Receives the TIMESTAMP_FORMAT flags of the timestamp.
+ * \return Whether the timestamp could be parsed.
+ */
+bool GTestResults::parseTimestamp(const QString& value, qint64* milliseconds, quint8* format) {
+	static const int SECONDS_LENGTH = 19;
+	int length = value.size();
+	quint8 flags = TIMESTAMP_GIVEN;
+	if(value.endsWith('Z')) {
+		flags |= TIMESTAMP_UTC;
+		--length;
+	}
+	int fraction = 0;
+	if(length == SECONDS_LENGTH + 4 && value.at(SECONDS_LENGTH) == '.') {
+		bool ok = false;
+		fraction = value.mid(SECONDS_LENGTH + 1, 3).toInt(&ok);
+		if(!ok || fraction < 0)
+			return false;
+		flags |= TIMESTAMP_MILLISECONDS;
+		length = SECONDS_LENGTH;
+	}
+	if(length != SECONDS_LENGTH || value.at(10) != 'T')
+		return false;
+	QDate date = QDate::fromString(value.left(10), "yyyy-MM-dd");
+	QTime clock = QTime::fromString(value.mid(11, 8), "HH:mm:ss");
+	if(!date.isValid() || !clock.isValid())
+		return false;
+	*milliseconds = QDateTime(date, clock, Qt::UTC).toMSecsSinceEpoch() + fraction;
+	*format = flags;
+	return true;
+}
+
+/*! \brief Writes a timestamp as it was given to parseTimestamp().
+ *
+ * \param milliseconds The timestamp in milliseconds since the epoch.
+ * \param format The TIMESTAMP_FORMAT flags of the timestamp.
+ */
+QString GTestResults::formatTimestamp(qint64 milliseconds, quint8 format) {
+	if(!(format & TIMESTAMP_GIVEN))
+		return QString();
+	QString value = QDateTime::fromMSecsSinceEpoch(milliseconds, Qt::UTC).toString(
+		(format & TIMESTAMP_MILLISECONDS) ? "yyyy-MM-dd'T'HH:mm:ss.zzz" : "yyyy-MM-dd'T'HH:mm:ss");
+	if(format & TIMESTAMP_UTC)
+		value.append('Z');
+	return value;
+}
+
+/*! \brief Adds a failure message to the list of failure messages.
+ *
+ * This appends a failure message to the end of the list of failure messages.
+ * \param failureMsg The failure message as retrieved from the gtest executable.
+ */
+void GTestResults::addFailureMessage(QString failureMsg) {
+	failureMessages.append(failureMsg);
+	failureLineCounts.append(failureMsg.isEmpty() ? 0 : failureMsg.count('\n') + (failureMsg.endsWith('\n') ? 0 : 1));
+}
+
+/*! \brief Sets an attribute, as given by gtest.
+ *
+ * An attribute with a field of its own is converted to the field's type.
+ * If it can't be, it is kept as a string instead.
+ */
+void GTestResults::addAttribute(QString name, QString value) {
+	for(int i = 0; i < STRING_ATTRIBUTE_COUNT; ++i) {
+		if(name == QLatin1String(stringAttributeNames[i])) {
+			strings[i] = intern(value);
+			return;
+		}
+	}
+	bool ok = false;
+	if(name == QLatin1String("time")) {
+		double seconds = value.toDouble(&ok);
+		if(ok && seconds >= 0) {
+			time = seconds;
+			otherAttributes.remove(name);
+			return;
+		}
+	} else if(name == QLatin1String("timestamp")) {
+		if(parseTimestamp(value, &timestamp, &timestampFormat)) {
+			otherAttributes.remove(name);
+			return;
+		}
+		timestampFormat = NO_TIMESTAMP;
+	} else if(name == QLatin1String("line")) {
+		int number = value.toInt(&ok);
+		if(ok && number >= 0) {
+			line = number;
+			return;
+		}
+	} else if(name == QLatin1String("status")) {
+		if(value == QLatin1String("run") || value == QLatin1String("notrun")) {
+			status = value == QLatin1String("run") ? RUN : NOTRUN;
+			return;
+		}
+	}
+	otherAttributes.insert(name, value);
+}
+
+/*! \brief Sets the time attribute.
+ *
+ * \param seconds The running time in seconds.
+ */
+void GTestResults::setTime(double seconds) {
+	time = seconds;
+	otherAttributes.remove("time");
+}
+
+/*! \brief Retrieves an attribute as a string, as gtest gave it.
+ *
+ * \param iname The name of the attribute.
+ * \return The value, or an empty string if the attribute wasn't given.
+ */
+QString GTestResults::get(QString iname) const {
+	for(int i = 0; i < STRING_ATTRIBUTE_COUNT; ++i) {
+		if(iname == QLatin1String(stringAttributeNames[i]))
+			return internedString(strings[i]);
+	}
+	if(iname == QLatin1String("time") && time >= 0)
+		return QString::number(time);
+	if(iname == QLatin1String("timestamp") && timestampFormat != NO_TIMESTAMP)
+		return formatTimestamp(timestamp, timestampFormat);
+	if(iname == QLatin1String("line") && line >= 0)
+		return QString::number(line);
+	if(iname == QLatin1String("status") && status != NO_STATUS)
+		return status == RUN ? "run" : "notrun";
+	return otherAttributes.value(iname);
+}
+
+/*! \brief Brings these results up to date with the final results of the same test.
+ *
+ * The attributes of 'other' replace those of the same name and its failure
+ * messages, which are the complete ones, replace those found so far.
+ * \param other The final results of the test.
+ */
+void GTestResults::enrich(const GTestResults& other) {
+	for(int i = 0; i < STRING_ATTRIBUTE_COUNT; ++i) {
+		if(other.strings[i] != -1)
+			strings[i] = other.strings[i];
+	}
+	if(other.line >= 0)
+		line = other.line;
+	if(other.time >= 0)
+		time = other.time;
+	if(other.timestampFormat != NO_TIMESTAMP) {
+		timestamp = other.timestamp;
+		timestampFormat = other.timestampFormat;
+	}
+	if(other.status != NO_STATUS)
+		status = other.status;
+	QHash<QString, QString>::const_iterator it = other.otherAttributes.begin();
+	for(; it != other.otherAttributes.end(); ++it)
+		otherAttributes.insert(it.key(), it.value());
+	failureMessages = other.failureMessages;
+	failureLineCounts = other.failureLineCounts;
+}
+
+/*! \brief Lists the attributes given, one "name: value" per line.
+ */
+QString GTestResults::serialiseAttributes() const {
     QString attribstr;
-    foreach(const QString &attr, attributes.keys()){
+    QStringList names;
+    for(int i = 0; i < STRING_ATTRIBUTE_COUNT; ++i) {
+        if(strings[i] != -1)
+            names << stringAttributeNames[i];
+    }
+    if(status != NO_STATUS)
+        names << "status";
+    if(timestampFormat != NO_TIMESTAMP)
+        names << "timestamp";
+    if(time >= 0)
+        names << "time";
+    if(line >= 0)
+        names << "line";
+    names << otherAttributes.keys();
+    foreach(const QString &attr, names){
         attribstr.append(attr);
         attribstr.append(": ");
-        attribstr.append(attributes.value(attr));
-        attribstr.append("\n\r");
+        attribstr.append(get(attr));
+        attribstr.append("\n");
     }
     return attribstr;
 }
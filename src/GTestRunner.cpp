@@ -23,6 +23,7 @@
 #include <QGroupBox>
 #include <QMessageBox>
 #include <QSharedPointer>
+#include <QShortcut>
 #include <QSignalMapper>
 #include <QTreeView>
 #include <QTreeWidgetItem>
@@ -65,6 +66,15 @@ void GTestRunner::setup() {
     QObject::connect(ism, SIGNAL(currentChanged(const QModelIndex& , const QModelIndex&)),
                      testModel, SLOT(printResult(const QModelIndex& , const QModelIndex&)));
 
+    QObject::connect(findEdit, SIGNAL(textChanged(const QString&)),
+                     result, SLOT(find(const QString&)));
+    QObject::connect(findEdit, SIGNAL(returnPressed()),
+                     this, SLOT(findAgain()));
+    QObject::connect(result, SIGNAL(searchFinished(bool)),
+                     this, SLOT(showSearchResult(bool)));
+    QObject::connect(new QShortcut(QKeySequence::Find, this), SIGNAL(activated()),
+                     findEdit, SLOT(setFocus()));
+
 	QObject::connect(this->aboutQtAction, SIGNAL(triggered()),
 					 qApp, SLOT(aboutQt()));
 
@@ -101,6 +111,41 @@ void GTestRunner::AddExecutable(QString filepath){
 }
 
 
+/*! \brief Set the number of shards each executable added afterwards is run with.
+ *
+ */
+void GTestRunner::SetShardCount(int shardCount){
+    testModel->setShardCount(shardCount);
+}
+
+/*! \brief Set whether executables added afterwards write their results as .json.
+ *
+ */
+void GTestRunner::SetJsonResults(bool jsonResults){
+    testModel->setJsonResults(jsonResults);
+}
+
+/*! \brief Set the number of previous runs executables added afterwards keep for comparison.
+ *
+ */
+void GTestRunner::SetKeptRuns(int keptRuns){
+    testModel->setKeptRuns(keptRuns);
+}
+
+/*! \brief Set the maximum number of test processes running at once.
+ *
+ */
+void GTestRunner::SetMaxProcesses(int maxProcesses){
+    testModel->setMaxProcesses(maxProcesses);
+}
+
+/*! \brief Set whether unchanged executables are recognised by a hash of their contents.
+ *
+ */
+void GTestRunner::SetHashListings(bool hashListings){
+    testModel->setHashListings(hashListings);
+}
+
 /*! \brief Disable run button while tests are running.
  *
  */
@@ -118,6 +163,25 @@ void GTestRunner::EnableRunAction() {
     statusBar()->showMessage("Done.");
 }
 
+/*! \brief Moves to the next match of the search, or the previous one with Shift held.
+ *
+ */
+void GTestRunner::findAgain() {
+    if(QApplication::keyboardModifiers() & Qt::ShiftModifier)
+        result->findPrevious();
+    else
+        result->findNext();
+}
+
+/*! \brief Tells the user when the search of the result pane found nothing.
+ *
+ */
+void GTestRunner::showSearchResult(bool found) {
+    if(found)
+        statusBar()->clearMessage();
+    else
+        statusBar()->showMessage(tr("Not found: %1").arg(findEdit->text()));
+}
 
 /*! \brief Slot to prompt a dialog to have the user add unit tests to run.
  *
@@ -26,9 +26,40 @@ GTestSuiteResults::GTestSuiteResults()
 
 /*! \brief Destructor
  *
+ * The results of the constituent tests (or suites) belong to the arenas of
+ * the tree's GTestExecutableResults, which release them.
  */
 GTestSuiteResults::~GTestSuiteResults()
 {}
 
+/*! \brief Merges the results of another run of the same suite into this one.
+ *
+ * This is used to recombine the results of a sharded run. Test results that
+ * only exist in 'other' are moved into this object, suites present in both are
+ * merged recursively and the test counters and running time are summed.
+ * The 'other' object is left empty.
+ * \param other The results to merge, from a tree whose arenas this tree
+ * 		  takes over (see GTestExecutableResults::merge()).
+ */
+void GTestSuiteResults::merge(GTestSuiteResults* other) {
+	if(!other || other == this)
+		return;
+	QHash<QString, GTestResults*>::iterator it = other->testResultsHash.begin();
+	while(it != other->testResultsHash.end()) {
+		GTestSuiteResults* existing = dynamic_cast<GTestSuiteResults*>(testResultsHash.value(it.key()));
+		GTestSuiteResults* incoming = dynamic_cast<GTestSuiteResults*>(it.value());
+		if(existing && incoming)
+			existing->merge(incoming);
+		else
+			testResultsHash.insert(it.key(), it.value());
+		++it;
+	}
+	other->testResultsHash.clear();
 
-
+	QStringList counters;
+	counters << "tests" << "failures" << "disabled" << "errors";
+	QString counter;
+	foreach(counter, counters)
+		addAttribute(counter, QString::number(get(counter).toInt() + other->get(counter).toInt()));
+	setTime(qMax(0.0, getTime()) + qMax(0.0, other->getTime()));
+}
@@ -0,0 +1,222 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * JsonStreamReader.cpp - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "JsonStreamReader.h"
+
+#include <QIODevice>
+
+/*! \brief Constructor
+ *
+ * \param device The device to read the document from. It must be open.
+ */
+JsonStreamReader::JsonStreamReader(QIODevice* device)
+: device(device), buffer(CHUNK_SIZE, '\0'), length(0), position(0), text(), containers(), token(NONE)
+{
+	//Reserving keeps the buffers allocated when they are emptied.
+	text.reserve(256);
+	containers.reserve(16);
+}
+
+/*! \brief Reads the next chunk of the document into the buffer.
+ *
+ * \return false at the end of the document.
+ */
+bool JsonStreamReader::fill() {
+	position = 0;
+	length = device ? (int)qMax<qint64>(0, device->read(buffer.data(), CHUNK_SIZE)) : 0;
+	return length > 0;
+}
+
+/*! \brief Reads the next byte of the document.
+ *
+ * \return The byte, or -1 at the end of the document.
+ */
+inline int JsonStreamReader::next() {
+	if(position == length && !fill())
+		return -1;
+	return (unsigned char)buffer.constData()[position++];
+}
+
+/*! \brief Retrieves the next byte of the document without reading past it.
+ *
+ * \return The byte, or -1 at the end of the document.
+ */
+inline int JsonStreamReader::peek() {
+	if(position == length && !fill())
+		return -1;
+	return (unsigned char)buffer.constData()[position];
+}
+
+/*! \brief Reads the next token of the document.
+ *
+ * \return The token, also given by getToken().
+ */
+JsonStreamReader::TOKEN JsonStreamReader::readNext() {
+	if(token == END_DOCUMENT || token == INVALID)
+		return token;
+	int c;
+	do {
+		c = next();
+	} while(c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == ',' || c == ':');
+	text.resize(0);
+	switch(c) {
+	case -1:
+		token = containers.isEmpty() ? END_DOCUMENT : INVALID;
+		break;
+	case '{':
+		containers.append('{');
+		token = BEGIN_OBJECT;
+		break;
+	case '[':
+		containers.append('[');
+		token = BEGIN_ARRAY;
+		break;
+	case '}':
+	case ']':
+		if(!containers.endsWith(c == '}' ? '{' : '[')) {
+			token = INVALID;
+			break;
+		}
+		containers.chop(1);
+		token = c == '}' ? END_OBJECT : END_ARRAY;
+		break;
+	case '"': {
+		//In an object, names and values take turns.
+		bool name = containers.endsWith('{') && token != NAME;
+		token = !readString() ? INVALID : name ? NAME : STRING;
+		break;
+	}
+	default:
+		token = readScalar(c);
+		break;
+	}
+	return token;
+}
+
+/*! \brief Reads a string into the text, up to and including its closing quote.
+ *
+ * Runs of plain bytes are copied a chunk at a time.
+ * \return false if the string is malformed or unterminated.
+ */
+bool JsonStreamReader::readString() {
+	for(;;) {
+		const char* data = buffer.constData();
+		int start = position;
+		while(position < length && data[position] != '"' && data[position] != '\\')
+			++position;
+		text.append(data + start, position - start);
+		if(position == length) {
+			if(!fill())
+				return false;
+			continue;
+		}
+		if(data[position++] == '"')
+			return true;
+		if(!readEscape())
+			return false;
+	}
+}
+
+/*! \brief Reads the escape sequence following a backslash into the text.
+ *
+ * gtest passes UTF-8 through unchanged and only escapes control characters,
+ * but any \\u escape is a code point, which is appended encoded as UTF-8.
+ * Surrogate pairs are combined into the code point they encode.
+ * \return false if the sequence is malformed.
+ */
+bool JsonStreamReader::readEscape() {
+	int c = next();
+	switch(c) {
+	case '"': case '\\': case '/':
+		text.append((char)c);
+		return true;
+	case 'b': text.append('\b'); return true;
+	case 'f': text.append('\f'); return true;
+	case 'n': text.append('\n'); return true;
+	case 'r': text.append('\r'); return true;
+	case 't': text.append('\t'); return true;
+	case 'u':
+		break;
+	default:
+		return false;
+	}
+	uint code;
+	if(!readHex(&code))
+		return false;
+	if(code < 0x80) {
+		text.append((char)code);
+		return true;
+	}
+	if(code >= 0xD800 && code < 0xDC00) {
+		uint low;
+		if(next() != '\\' || next() != 'u' || !readHex(&low) || low < 0xDC00 || low >= 0xE000)
+			return false;
+		code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+	}
+	if(code < 0x800) {
+		text.append((char)(0xC0 | (code >> 6)));
+	} else if(code < 0x10000) {
+		text.append((char)(0xE0 | (code >> 12)));
+		text.append((char)(0x80 | ((code >> 6) & 0x3F)));
+	} else {
+		text.append((char)(0xF0 | (code >> 18)));
+		text.append((char)(0x80 | ((code >> 12) & 0x3F)));
+		text.append((char)(0x80 | ((code >> 6) & 0x3F)));
+	}
+	text.append((char)(0x80 | (code & 0x3F)));
+	return true;
+}
+
+/*! \brief Reads the four hexadecimal digits of a \\u escape.
+ *
+ * \return false if they aren't four hexadecimal digits.
+ */
+bool JsonStreamReader::readHex(uint* code) {
+	*code = 0;
+	for(int i = 0; i < 4; ++i) {
+		int c = next();
+		int digit;
+		if(c >= '0' && c <= '9')
+			digit = c - '0';
+		else if(c >= 'a' && c <= 'f')
+			digit = c - 'a' + 10;
+		else if(c >= 'A' && c <= 'F')
+			digit = c - 'A' + 10;
+		else
+			return false;
+		*code = (*code << 4) | digit;
+	}
+	return true;
+}
+
+/*! \brief Reads a number or a literal into the text.
+ *
+ * \param first The first byte of the value, already read.
+ * \return The kind of value, or INVALID if it is neither.
+ */
+JsonStreamReader::TOKEN JsonStreamReader::readScalar(int first) {
+	bool number = first == '-' || (first >= '0' && first <= '9');
+	if(!number && (first < 'a' || first > 'z'))
+		return INVALID;
+	text.append((char)first);
+	int c;
+	while((c = peek()) != -1 && ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+								  || c == '.' || c == '+' || c == '-')) {
+		text.append((char)c);
+		++position;
+	}
+	return number ? NUMBER : LITERAL;
+}
@@ -0,0 +1,222 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * ListingCache.cpp - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "ListingCache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtEndian>
+
+/*! \brief The first line of every cache file, changed if the format changes.
+ */
+static const char CACHE_MAGIC[] = "gtest-runner listing cache 1";
+
+/*! \brief Reads a little endian integer of type T at 'offset', or 0 if out of range.
+ */
+template <class T>
+static T readLittleEndian(const QByteArray& data, int offset) {
+	if(offset < 0 || offset + int(sizeof(T)) > data.size())
+		return 0;
+	return qFromLittleEndian<T>(reinterpret_cast<const uchar*>(data.constData() + offset));
+}
+
+/*! \brief Constructor
+ *
+ */
+ExecutableIdentity::ExecutableIdentity()
+: size(-1), modified(0), fingerprint()
+{}
+
+/*! \brief Whether the two identities refer to the same build.
+ */
+bool ExecutableIdentity::operator==(const ExecutableIdentity& other) const {
+	if(!isValid() || !other.isValid() || size != other.size)
+		return false;
+	if(!fingerprint.isEmpty() && !other.fingerprint.isEmpty())
+		return fingerprint == other.fingerprint;
+	return modified == other.modified;
+}
+
+/*! \brief Constructor
+ *
+ * \param directory The directory to keep the cache files in. If empty, the
+ * 		  directory "listings" in the user's cache directory is used.
+ */
+ListingCache::ListingCache(QString directory)
+: directory(directory), hashContents(false), hashedIdentities()
+{
+	if(this->directory.isEmpty())
+		this->directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/listings";
+}
+
+/*! \brief Destructor
+ *
+ */
+ListingCache::~ListingCache()
+{}
+
+/*! \brief Retrieves the path of the cache file for an executable.
+ *
+ * The file is named after a hash of the executable's absolute path.
+ */
+QString ListingCache::cacheFilePath(const QString& executablePath) const {
+	QByteArray key = QFileInfo(executablePath).absoluteFilePath().toUtf8();
+	return directory + "/" + QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex() + ".listing";
+}
+
+/*! \brief Identifies the current build of an executable.
+ *
+ * The size and modification time are always read. The fingerprint is the
+ * ELF build-id if the file has one, else a hash of its contents if
+ * getHashContents() is set. The contents are only hashed again once the
+ * size or modification time of the file change, as this reads the whole
+ * file on the GUI thread.
+ * \param executablePath The path of the executable.
+ * \return The identity of the file, invalid if it couldn't be read.
+ */
+ExecutableIdentity ListingCache::identify(const QString& executablePath) const {
+	ExecutableIdentity identity;
+	QFileInfo info(executablePath);
+	if(!info.exists())
+		return identity;
+	identity.size = info.size();
+	identity.modified = info.lastModified().toMSecsSinceEpoch();
+	identity.fingerprint = readBuildId(executablePath);
+	if(identity.fingerprint.isEmpty() && hashContents) {
+		QString key = info.absoluteFilePath();
+		ExecutableIdentity hashed = hashedIdentities.value(key);
+		if(hashed.size == identity.size && hashed.modified == identity.modified) {
+			identity.fingerprint = hashed.fingerprint;
+			return identity;
+		}
+		QFile file(executablePath);
+		QCryptographicHash hash(QCryptographicHash::Sha1);
+		if(file.open(QIODevice::ReadOnly)) {
+			while(!file.atEnd())
+				hash.addData(file.read(1 << 20));
+			identity.fingerprint = "sha1:" + hash.result().toHex();
+			hashedIdentities.insert(key, identity);
+		}
+	}
+	return identity;
+}
+
+/*! \brief Reads the GNU build-id note of an ELF executable.
+ *
+ * Only the program headers and note segments are read, so this is cheap even
+ * for large executables. Only little endian ELF files are supported.
+ * \param executablePath The path of the executable.
+ * \return The build-id prefixed with "build-id:", or an empty array if the
+ * 		   file isn't an ELF file or has no build-id.
+ */
+QByteArray ListingCache::readBuildId(const QString& executablePath) {
+	QFile file(executablePath);
+	if(!file.open(QIODevice::ReadOnly))
+		return QByteArray();
+	QByteArray header = file.read(64);
+	if(header.size() < 52 || !header.startsWith("\x7f" "ELF") || header.at(5) != 1)
+		return QByteArray();
+	bool is64 = header.at(4) == 2;
+	if(is64 && header.size() < 64)
+		return QByteArray();
+	quint64 programHeaders = is64 ? readLittleEndian<quint64>(header, 32) : readLittleEndian<quint32>(header, 28);
+	quint16 entrySize = readLittleEndian<quint16>(header, is64 ? 54 : 42);
+	quint16 entryCount = readLittleEndian<quint16>(header, is64 ? 56 : 44);
+	for(int i = 0; i < entryCount; ++i) {
+		if(!file.seek(programHeaders + quint64(i) * entrySize))
+			break;
+		QByteArray entry = file.read(entrySize);
+		const quint32 PT_NOTE = 4;
+		if(readLittleEndian<quint32>(entry, 0) != PT_NOTE)
+			continue;
+		quint64 offset = is64 ? readLittleEndian<quint64>(entry, 8) : readLittleEndian<quint32>(entry, 4);
+		quint64 size = is64 ? readLittleEndian<quint64>(entry, 32) : readLittleEndian<quint32>(entry, 16);
+		if(!file.seek(offset))
+			continue;
+		QByteArray notes = file.read(qMin<quint64>(size, 1 << 16));
+		int position = 0;
+		while(position + 12 <= notes.size()) {
+			quint32 nameSize = readLittleEndian<quint32>(notes, position);
+			quint32 descriptionSize = readLittleEndian<quint32>(notes, position + 4);
+			quint32 type = readLittleEndian<quint32>(notes, position + 8);
+			qint64 name = position + 12;
+			qint64 description = name + ((qint64(nameSize) + 3) & ~3);
+			if(description + descriptionSize > notes.size())
+				break;
+			const quint32 NT_GNU_BUILD_ID = 3;
+			if(type == NT_GNU_BUILD_ID && nameSize == 4 && notes.mid(name, 4) == QByteArray("GNU", 4))
+				return "build-id:" + notes.mid(description, descriptionSize).toHex();
+			position = description + ((qint64(descriptionSize) + 3) & ~3);
+		}
+	}
+	return QByteArray();
+}
+
+/*! \brief Retrieves the cached listing of an executable.
+ *
+ * \param executablePath The path of the executable.
+ * \param identity The current identity of the executable.
+ * \param listing Receives the cached listing on success.
+ * \return true if a listing for this build of the executable was cached.
+ */
+bool ListingCache::lookup(const QString& executablePath, const ExecutableIdentity& identity, QByteArray* listing) const {
+	if(!identity.isValid() || !listing)
+		return false;
+	QFile file(cacheFilePath(executablePath));
+	if(!file.open(QIODevice::ReadOnly))
+		return false;
+	if(file.readLine().trimmed() != CACHE_MAGIC
+	   || QString::fromUtf8(file.readLine().trimmed()) != QFileInfo(executablePath).absoluteFilePath())
+		return false;
+	ExecutableIdentity cached;
+	cached.size = file.readLine().trimmed().toLongLong();
+	cached.modified = file.readLine().trimmed().toLongLong();
+	cached.fingerprint = file.readLine().trimmed();
+	if(cached != identity)
+		return false;
+	*listing = file.readAll();
+	return true;
+}
+
+/*! \brief Stores the listing of an executable.
+ *
+ * \param executablePath The path of the executable.
+ * \param identity The identity of the executable the listing was produced by.
+ * \param listing The raw output of --gtest_list_tests.
+ * \return true if the listing was written. An entry that couldn't be
+ * 		   written in full leaves the previous one in place.
+ */
+bool ListingCache::store(const QString& executablePath, const ExecutableIdentity& identity, const QByteArray& listing) const {
+	if(!identity.isValid())
+		return false;
+	QDir().mkpath(directory);
+	QSaveFile file(cacheFilePath(executablePath));
+	if(!file.open(QIODevice::WriteOnly))
+		return false;
+	file.write(CACHE_MAGIC);
+	file.write("\n");
+	file.write(QFileInfo(executablePath).absoluteFilePath().toUtf8() + "\n");
+	file.write(QByteArray::number(identity.size) + "\n");
+	file.write(QByteArray::number(identity.modified) + "\n");
+	file.write(identity.fingerprint + "\n");
+	file.write(listing);
+	return file.commit();
+}
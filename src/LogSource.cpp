@@ -0,0 +1,195 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * LogSource.cpp - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "LogSource.h"
+
+#include <algorithm>
+#include <cstring>
+
+/*! \brief Destructor
+ *
+ */
+LogSource::~LogSource() {}
+
+/*! \brief Constructor
+ *
+ * The lines of the text are indexed once, so that any of them can be read
+ * without scanning the text again.
+ */
+TextLogSource::TextLogSource(const QByteArray& text)
+: text(text), lineOffsets()
+{
+	if(!this->text.isEmpty() && !this->text.endsWith('\n'))
+		this->text.append('\n');
+	const char* data = this->text.constData();
+	const char* end = data + this->text.size();
+	const char* line = data;
+	const char* newline;
+	while((newline = static_cast<const char*>(memchr(line, '\n', end - line))) != 0) {
+		lineOffsets.append(line - data);
+		line = newline + 1;
+	}
+	lineOffsets.append(this->text.size());
+}
+
+/*! \brief Retrieves the number of lines in the text.
+ */
+qint64 TextLogSource::getLineCount() const {
+	return lineOffsets.size() - 1;
+}
+
+/*! \brief Reads consecutive lines of the text.
+ *
+ * \param firstLine The first line to read, counted from 0.
+ * \param count The number of lines to read.
+ * \return The lines, which are fewer than 'count' past the last line.
+ */
+QByteArray TextLogSource::readLines(qint64 firstLine, int count) const {
+	qint64 lines = getLineCount();
+	if(firstLine < 0 || firstLine >= lines || count <= 0)
+		return QByteArray();
+	int first = (int)firstLine;
+	int last = (int)qMin<qint64>(firstLine + count, lines);
+	return text.mid(lineOffsets.at(first), lineOffsets.at(last) - lineOffsets.at(first));
+}
+
+/*! \brief Constructor
+ *
+ * \param message The message.
+ * \param lineCount The number of lines of the message, as countLines()
+ * 		  gives it, or -1 to count them here.
+ */
+MessageLogSource::MessageLogSource(const QString& message, qint64 lineCount)
+: message(message), lineCount(lineCount >= 0 ? lineCount : countLines(message)), text()
+{}
+
+/*! \brief Counts the lines of a message, including an unterminated last line.
+ */
+qint64 MessageLogSource::countLines(const QString& message) {
+	if(message.isEmpty())
+		return 0;
+	return message.count('\n') + (message.endsWith('\n') ? 0 : 1);
+}
+
+/*! \brief Retrieves the number of lines of the message.
+ */
+qint64 MessageLogSource::getLineCount() const {
+	return lineCount;
+}
+
+/*! \brief Reads consecutive lines of the message.
+ *
+ * The message is encoded and indexed the first time it is read.
+ * \param firstLine The first line to read, counted from 0.
+ * \param count The number of lines to read.
+ * \return The lines, which are fewer than 'count' past the last line.
+ */
+QByteArray MessageLogSource::readLines(qint64 firstLine, int count) const {
+	if(firstLine < 0 || firstLine >= lineCount || count <= 0)
+		return QByteArray();
+	if(!text)
+		text = QSharedPointer<TextLogSource>(new TextLogSource(message.toLocal8Bit()));
+	return text->readLines(firstLine, count);
+}
+
+/*! \brief Constructor
+ *
+ * \param capture The captured output.
+ * \param start The offset of the range, normally the start of a line.
+ * \param end The offset just past the range.
+ */
+CaptureLogSource::CaptureLogSource(OutputCapturePointer capture, qint64 start, qint64 end)
+: capture(capture), start(qMax<qint64>(0, start)), end(end), firstLine(0), lineCount(0)
+{
+	if(!capture || this->end <= this->start)
+		return;
+	firstLine = capture->getLineAt(this->start);
+	qint64 lastLine = capture->getLineAt(this->end);
+	//The range may end part way through its last line.
+	lineCount = lastLine - firstLine + (this->end > capture->getLineOffset(lastLine) ? 1 : 0);
+}
+
+/*! \brief Retrieves the number of lines in the range.
+ */
+qint64 CaptureLogSource::getLineCount() const {
+	return lineCount;
+}
+
+/*! \brief Reads consecutive lines of the range.
+ *
+ * At most MAX_READ bytes are read, so very long lines may cut the lines
+ * read short.
+ * \param firstLine The first line to read, counted from the start of the range.
+ * \param count The number of lines to read.
+ * \return The lines, which are fewer than 'count' past the last line.
+ */
+QByteArray CaptureLogSource::readLines(qint64 firstLine, int count) const {
+	if(firstLine < 0 || firstLine >= lineCount || count <= 0)
+		return QByteArray();
+	qint64 from = qMax(start, capture->getLineOffset(this->firstLine + firstLine));
+	qint64 to = qMin(end, capture->getLineOffset(this->firstLine + qMin(firstLine + count, lineCount)));
+	QByteArray lines = capture->read(from, (int)qMin<qint64>(to - from, MAX_READ));
+	if(!lines.isEmpty() && !lines.endsWith('\n'))
+		lines.append('\n');
+	return lines;
+}
+
+/*! \brief Constructor
+ *
+ * \param sources The sources, in the order their lines are shown. Null
+ * 		  sources are skipped.
+ */
+ConcatenatedLogSource::ConcatenatedLogSource(const QList<LogSourcePointer>& sources)
+: sources(), firstLines()
+{
+	qint64 lines = 0;
+	foreach(LogSourcePointer source, sources) {
+		if(!source)
+			continue;
+		this->sources.append(source);
+		firstLines.append(lines);
+		lines += source->getLineCount();
+	}
+	firstLines.append(lines);
+}
+
+/*! \brief Retrieves the number of lines of all the sources.
+ */
+qint64 ConcatenatedLogSource::getLineCount() const {
+	return firstLines.last();
+}
+
+/*! \brief Reads consecutive lines, from as many of the sources as they span.
+ *
+ * \param firstLine The first line to read, counted from 0.
+ * \param count The number of lines to read.
+ * \return The lines, which are fewer than 'count' past the last line.
+ */
+QByteArray ConcatenatedLogSource::readLines(qint64 firstLine, int count) const {
+	QByteArray lines;
+	if(firstLine < 0 || count <= 0)
+		return lines;
+	int source = std::upper_bound(firstLines.begin(), firstLines.end() - 1, firstLine) - firstLines.begin() - 1;
+	qint64 line = firstLine;
+	qint64 last = qMin(firstLine + count, getLineCount());
+	for(; source < sources.size() && line < last; ++source) {
+		qint64 sourceLine = line - firstLines.at(source);
+		int sourceCount = (int)(qMin(last, firstLines.at(source + 1)) - line);
+		lines.append(sources.at(source)->readLines(sourceLine, sourceCount));
+		line += sourceCount;
+	}
+	return lines;
+}
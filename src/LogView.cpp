@@ -0,0 +1,363 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * LogView.cpp - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "LogView.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QFontMetrics>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QTimer>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+//The space left of the text, in pixels.
+static const int MARGIN = 4;
+
+/*! \brief Constructor
+ *
+ */
+LogView::LogView(QWidget* parent)
+: QAbstractScrollArea(parent), source(), lineCount(0), pageFirstLine(0), page(), longestLine(0),
+  searchPattern(), searchForward(true), searchLine(0), searchedLines(0), matchLine(-1),
+  selectionAnchor(-1), selectionEnd(-1)
+{
+	searchTimer = new QTimer(this);
+	searchTimer->setInterval(0);
+	QObject::connect(searchTimer, SIGNAL(timeout()), this, SLOT(searchStep()));
+	verticalScrollBar()->setSingleStep(1);
+	updateScrollBars();
+}
+
+/*! \brief Shows the lines of a source, from the top.
+ *
+ * A search in progress starts over in the new lines.
+ */
+void LogView::setSource(LogSourcePointer source) {
+	this->source = source;
+	lineCount = source ? source->getLineCount() : 0;
+	pageFirstLine = 0;
+	page.clear();
+	longestLine = 0;
+	matchLine = -1;
+	selectionAnchor = -1;
+	selectionEnd = -1;
+	searchTimer->stop();
+	updateScrollBars();
+	verticalScrollBar()->setValue(0);
+	horizontalScrollBar()->setValue(0);
+	viewport()->update();
+	if(!searchPattern.isEmpty())
+		startSearch(0, true);
+}
+
+/*! \brief Shows a text held in memory.
+ *
+ * This is a convenience for setSource() with a TextLogSource.
+ */
+void LogView::setText(const QString& text) {
+	setSource(LogSourcePointer(new TextLogSource(text.toLocal8Bit())));
+}
+
+/*! \brief Empties the view.
+ *
+ */
+void LogView::clear() {
+	setSource(LogSourcePointer());
+}
+
+/*! \brief Retrieves the number of lines that fit in the view entirely.
+ */
+int LogView::visibleLineCount() const {
+	return qMax(1, viewport()->height() / QFontMetrics(font()).lineSpacing());
+}
+
+/*! \brief Fits the ranges of the scroll bars to the lines and the view.
+ */
+void LogView::updateScrollBars() {
+	int visible = visibleLineCount();
+	verticalScrollBar()->setPageStep(visible);
+	verticalScrollBar()->setRange(0, (int)qMin<qint64>(INT_MAX, qMax<qint64>(0, lineCount - visible)));
+	horizontalScrollBar()->setPageStep(viewport()->width());
+	horizontalScrollBar()->setRange(0, qMax(0, longestLine + 2 * MARGIN - viewport()->width()));
+}
+
+/*! \brief Reads the lines around those about to be shown, unless they have been read already.
+ *
+ * A page of lines on either side is read along with them, so scrolling
+ * by a line or a page doesn't go back to the source every time.
+ */
+void LogView::readPage(qint64 firstLine, int count) {
+	qint64 lastLine = qMin(firstLine + count, lineCount);
+	if(firstLine >= pageFirstLine && lastLine <= pageFirstLine + page.size())
+		return;
+	page.clear();
+	pageFirstLine = qMax<qint64>(0, firstLine - count);
+	if(!source)
+		return;
+	QByteArray lines = source->readLines(pageFirstLine, 3 * count);
+	const char* data = lines.constData();
+	const char* end = data + lines.size();
+	const char* line = data;
+	const char* newline;
+	while((newline = static_cast<const char*>(memchr(line, '\n', end - line))) != 0) {
+		page.append(QByteArray(line, newline - line));
+		line = newline + 1;
+	}
+}
+
+/*! \brief Retrieves a line as it is drawn.
+ *
+ * The line must have been read by readPage(). Tabs are expanded and very
+ * long lines are cut short.
+ */
+QString LogView::lineText(qint64 line) {
+	qint64 index = line - pageFirstLine;
+	if(index < 0 || index >= page.size())
+		return QString();
+	const QByteArray& bytes = page.at((int)index);
+	QString text = QString::fromLocal8Bit(bytes.constData(), qMin(bytes.size(), MAX_LINE_LENGTH));
+	if(text.endsWith('\r'))
+		text.chop(1);
+	text.replace('\t', "    ");
+	return text;
+}
+
+/*! \brief Draws the visible lines.
+ *
+ */
+void LogView::paintEvent(QPaintEvent* event) {
+	Q_UNUSED(event);
+	QPainter painter(viewport());
+	QFontMetrics metrics(font());
+	int lineHeight = metrics.lineSpacing();
+	qint64 firstLine = verticalScrollBar()->value();
+	//Include the partly visible line at the bottom.
+	int count = visibleLineCount() + 1;
+	readPage(firstLine, count);
+	int x = MARGIN - horizontalScrollBar()->value();
+	int widest = longestLine;
+	for(int i = 0; i < count && firstLine + i < lineCount; ++i) {
+		QString text = lineText(firstLine + i);
+		int y = i * lineHeight;
+		if(firstLine + i == matchLine || isSelected(firstLine + i)) {
+			painter.fillRect(0, y, viewport()->width(), lineHeight, palette().highlight());
+			painter.setPen(palette().color(QPalette::HighlightedText));
+		} else {
+			painter.setPen(palette().color(QPalette::Text));
+		}
+		painter.drawText(x, y + metrics.ascent(), text);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+		widest = qMax(widest, metrics.horizontalAdvance(text));
+#else
+		widest = qMax(widest, metrics.width(text));
+#endif
+	}
+	if(widest > longestLine) {
+		longestLine = widest;
+		updateScrollBars();
+	}
+}
+
+/*! \brief Refits the scroll bars to the new size of the view.
+ *
+ */
+void LogView::resizeEvent(QResizeEvent* event) {
+	QAbstractScrollArea::resizeEvent(event);
+	updateScrollBars();
+}
+
+/*! \brief Copies the selected lines to the clipboard on QKeySequence::Copy.
+ *
+ * If no line is selected, the visible lines are copied. All the lines are
+ * selected on QKeySequence::SelectAll. Other keys scroll the view as in
+ * any QAbstractScrollArea.
+ */
+void LogView::keyPressEvent(QKeyEvent* event) {
+	if(event->matches(QKeySequence::Copy)) {
+		if(!source)
+			return;
+		qint64 firstLine = verticalScrollBar()->value();
+		qint64 count = visibleLineCount();
+		if(selectionAnchor >= 0) {
+			firstLine = qMin(selectionAnchor, selectionEnd);
+			count = qAbs(selectionEnd - selectionAnchor) + 1;
+		}
+		QApplication::clipboard()->setText(QString::fromLocal8Bit(
+			source->readLines(firstLine, (int)qMin<qint64>(INT_MAX, count))));
+		return;
+	}
+	if(event->matches(QKeySequence::SelectAll)) {
+		if(lineCount > 0) {
+			selectionAnchor = 0;
+			selectionEnd = lineCount - 1;
+			viewport()->update();
+		}
+		return;
+	}
+	QAbstractScrollArea::keyPressEvent(event);
+}
+
+/*! \brief Retrieves the line drawn at a height in the view.
+ *
+ * \param y The height, which may be above or below the view.
+ * \return The line, clamped to the lines of the log, or -1 if it is empty.
+ */
+qint64 LogView::lineAt(int y) const {
+	if(lineCount == 0)
+		return -1;
+	int lineHeight = QFontMetrics(font()).lineSpacing();
+	qint64 row = y < 0 ? -1 : y / lineHeight;
+	return qBound<qint64>(0, verticalScrollBar()->value() + row, lineCount - 1);
+}
+
+/*! \brief Checks whether a line is part of the selection.
+ */
+bool LogView::isSelected(qint64 line) const {
+	return selectionAnchor >= 0 && line >= qMin(selectionAnchor, selectionEnd)
+		&& line <= qMax(selectionAnchor, selectionEnd);
+}
+
+/*! \brief Starts a selection on the line clicked, or extends it with Shift held.
+ *
+ */
+void LogView::mousePressEvent(QMouseEvent* event) {
+	if(event->button() != Qt::LeftButton) {
+		QAbstractScrollArea::mousePressEvent(event);
+		return;
+	}
+	qint64 line = lineAt(event->pos().y());
+	if(!(event->modifiers() & Qt::ShiftModifier) || selectionAnchor < 0)
+		selectionAnchor = line;
+	selectionEnd = line;
+	viewport()->update();
+}
+
+/*! \brief Extends the selection to the line under the mouse while it is dragged.
+ *
+ * Dragging above or below the view scrolls it a line at a time.
+ */
+void LogView::mouseMoveEvent(QMouseEvent* event) {
+	if(!(event->buttons() & Qt::LeftButton) || selectionAnchor < 0) {
+		QAbstractScrollArea::mouseMoveEvent(event);
+		return;
+	}
+	int y = event->pos().y();
+	if(y < 0)
+		verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepSub);
+	else if(y >= viewport()->height())
+		verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepAdd);
+	selectionEnd = lineAt(y);
+	viewport()->update();
+}
+
+/*! \brief Scrolls a line into the middle of the view, unless it is visible already.
+ *
+ */
+void LogView::showLine(qint64 line) {
+	qint64 firstLine = verticalScrollBar()->value();
+	int visible = visibleLineCount();
+	if(line < firstLine || line >= firstLine + visible)
+		verticalScrollBar()->setValue((int)qMin<qint64>(INT_MAX, qMax<qint64>(0, line - visible / 2)));
+	viewport()->update();
+}
+
+/*! \brief Searches for text as it is typed.
+ *
+ * The current match is kept if it still matches, so the search narrows as
+ * more of the text is typed. The search is case insensitive.
+ * \param text The text to search for. If it is empty, the search ends.
+ */
+void LogView::find(const QString& text) {
+	searchPattern = text.toLocal8Bit().toLower();
+	if(searchPattern.isEmpty()) {
+		searchTimer->stop();
+		matchLine = -1;
+		viewport()->update();
+		return;
+	}
+	startSearch(matchLine >= 0 ? matchLine : verticalScrollBar()->value(), true);
+}
+
+/*! \brief Searches for the next match after the current one.
+ *
+ */
+void LogView::findNext() {
+	if(!searchPattern.isEmpty())
+		startSearch(matchLine >= 0 ? matchLine + 1 : verticalScrollBar()->value(), true);
+}
+
+/*! \brief Searches for the previous match before the current one.
+ *
+ */
+void LogView::findPrevious() {
+	if(!searchPattern.isEmpty())
+		startSearch(matchLine >= 0 ? matchLine - 1 : verticalScrollBar()->value(), false);
+}
+
+/*! \brief Starts searching from a line, wrapping around at the end of the log.
+ *
+ * The search itself runs in searchStep().
+ */
+void LogView::startSearch(qint64 line, bool forward) {
+	searchForward = forward;
+	searchLine = line;
+	searchedLines = 0;
+	searchTimer->start();
+}
+
+/*! \brief Searches the next batch of lines.
+ *
+ * At most SEARCH_BATCH lines are read and searched at a time, so that the
+ * event loop keeps running through a search of any number of lines.
+ */
+void LogView::searchStep() {
+	if(!source || searchedLines >= lineCount) {
+		searchTimer->stop();
+		matchLine = -1;
+		viewport()->update();
+		emit searchFinished(false);
+		return;
+	}
+	if(searchLine >= lineCount)
+		searchLine = 0;
+	else if(searchLine < 0)
+		searchLine = lineCount - 1;
+	qint64 batch = qMin<qint64>(SEARCH_BATCH, lineCount - searchedLines);
+	qint64 firstLine;
+	if(searchForward) {
+		batch = qMin(batch, lineCount - searchLine);
+		firstLine = searchLine;
+	} else {
+		batch = qMin(batch, searchLine + 1);
+		firstLine = searchLine - batch + 1;
+	}
+	QByteArray lines = source->readLines(firstLine, (int)batch).toLower();
+	int match = searchForward ? lines.indexOf(searchPattern) : lines.lastIndexOf(searchPattern);
+	searchedLines += batch;
+	searchLine = searchForward ? firstLine + batch : firstLine - 1;
+	if(match < 0)
+		return;
+	searchTimer->stop();
+	matchLine = firstLine + std::count(lines.constData(), lines.constData() + match, '\n');
+	showLine(matchLine);
+	emit searchFinished(true);
+}
@@ -0,0 +1,299 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * OutputCapture.cpp - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "OutputCapture.h"
+
+#include <QMutexLocker>
+#include <QTemporaryFile>
+
+#include <algorithm>
+#include <cstring>
+
+//The size of the ring once it holds any output.
+static const int MIN_RING_SIZE = 4096;
+
+/*! \brief Constructor
+ *
+ * No memory is taken for the ring until output is appended.
+ * \param capacity The most bytes held in memory.
+ * \param lineIndexStride The number of lines between two indexed line offsets.
+ */
+OutputCapture::OutputCapture(int capacity, int lineIndexStride)
+: mutex(), ring(), capacity(qMax(1, capacity)), ringStart(0), ringLength(0), totalSize(0),
+  spill(0), spilledSize(0), lineIndexStride(qMax(1, lineIndexStride)), lineIndex(), newlineCount(0),
+  spillError()
+{
+	lineIndex.append(0);
+}
+
+/*! \brief Destructor
+ *
+ * Removes the spill file, if any.
+ */
+OutputCapture::~OutputCapture() {
+	delete spill;
+}
+
+/*! \brief Appends output to the capture.
+ *
+ * Whatever no longer fits in the ring is pushed out to the spill file,
+ * oldest first.
+ */
+void OutputCapture::append(const QByteArray& data) {
+	if(data.isEmpty())
+		return;
+	QMutexLocker locker(&mutex);
+	const char* bytes = data.constData();
+	int length = data.size();
+
+	//Index the lines that start within the new data.
+	const char* end = bytes + length;
+	const char* newline = bytes;
+	while((newline = static_cast<const char*>(memchr(newline, '\n', end - newline))) != 0) {
+		++newline;
+		if(++newlineCount % lineIndexStride == 0) {
+			if(lineIndex.size() == MAX_LINE_INDEX_SIZE) {
+				//Keep every other entry, those of the lines on the doubled stride.
+				for(int i = 0; 2 * i < lineIndex.size(); ++i)
+					lineIndex[i] = lineIndex.at(2 * i);
+				lineIndex.resize((lineIndex.size() + 1) / 2);
+				lineIndexStride *= 2;
+			}
+			if(newlineCount % lineIndexStride == 0)
+				lineIndex.append(totalSize + (newline - bytes));
+		}
+	}
+	totalSize += length;
+
+	growRing(length);
+	const int ringSize = ring.size();
+	int overflow = ringLength + length - ringSize;
+	if(overflow > 0) {
+		//Push the oldest bytes out of the ring first, then the head of the new data.
+		int evicted = qMin(overflow, ringLength);
+		int firstPart = qMin(evicted, ringSize - ringStart);
+		spillBytes(ring.constData() + ringStart, firstPart);
+		spillBytes(ring.constData(), evicted - firstPart);
+		ringStart = (ringStart + evicted) % ringSize;
+		ringLength -= evicted;
+		if(overflow > evicted) {
+			spillBytes(bytes, overflow - evicted);
+			bytes += overflow - evicted;
+			length -= overflow - evicted;
+		}
+	}
+	int writePosition = (ringStart + ringLength) % ringSize;
+	int firstPart = qMin(length, ringSize - writePosition);
+	memcpy(ring.data() + writePosition, bytes, firstPart);
+	memcpy(ring.data(), bytes + firstPart, length - firstPart);
+	ringLength += length;
+}
+
+/*! \brief Grows the ring, up to its capacity, to make room for new output.
+ *
+ * The ring at least doubles each time it grows, and the bytes it holds are
+ * moved to its start.
+ * \param length The number of bytes about to be appended.
+ */
+void OutputCapture::growRing(int length) {
+	int size = ring.size();
+	if(size == capacity || ringLength + length <= size)
+		return;
+	int newSize = qMin(capacity, qMax(qMax(ringLength + length, 2 * size), MIN_RING_SIZE));
+	QByteArray grown(newSize, '\0');
+	int firstPart = qMin(ringLength, size - ringStart);
+	memcpy(grown.data(), ring.constData() + ringStart, firstPart);
+	memcpy(grown.data() + firstPart, ring.constData(), ringLength - firstPart);
+	ring = grown;
+	ringStart = 0;
+}
+
+/*! \brief Appends bytes pushed out of the ring to the spill file.
+ *
+ * The spill file is created on first use. If it can't be written the bytes
+ * are lost, which getSpillError() reports, but the capture keeps its offsets
+ * so the rest stays readable.
+ */
+void OutputCapture::spillBytes(const char* data, int length) {
+	if(length <= 0)
+		return;
+	if(!spill) {
+		spill = new QTemporaryFile();
+		if(!spill->open() && spillError.isEmpty())
+			spillError = spill->errorString();
+	}
+	if(spill->isOpen()) {
+		if((!spill->seek(spilledSize) || spill->write(data, length) != length) && spillError.isEmpty())
+			spillError = spill->errorString();
+	}
+	spilledSize += length;
+}
+
+/*! \brief Retrieves why output pushed out of the ring could not be spilled to disk.
+ *
+ * \return The error of the first failed write, or an empty string if every
+ * 		  byte has been spilled.
+ */
+QString OutputCapture::getSpillError() const {
+	QMutexLocker locker(&mutex);
+	return spillError;
+}
+
+/*! \brief Retrieves the number of lines between two indexed line offsets.
+ */
+int OutputCapture::getLineIndexStride() const {
+	QMutexLocker locker(&mutex);
+	return lineIndexStride;
+}
+
+/*! \brief Retrieves the number of bytes captured, including those spilled to disk.
+ */
+qint64 OutputCapture::getSize() const {
+	QMutexLocker locker(&mutex);
+	return totalSize;
+}
+
+/*! \brief Retrieves the number of bytes that have been spilled to disk.
+ */
+qint64 OutputCapture::getSpilledSize() const {
+	QMutexLocker locker(&mutex);
+	return spilledSize;
+}
+
+/*! \brief Retrieves the number of lines captured, counting an unterminated last line.
+ */
+qint64 OutputCapture::getLineCount() const {
+	QMutexLocker locker(&mutex);
+	if(totalSize == 0)
+		return 0;
+	//Output that ends with a newline has no partial last line.
+	bool terminated = ringLength > 0
+		&& ring.at((ringStart + ringLength - 1) % ring.size()) == '\n';
+	return newlineCount + (terminated ? 0 : 1);
+}
+
+/*! \brief Retrieves the offset of the first byte of a line.
+ *
+ * The nearest indexed line before it is looked up and the lines in between
+ * are scanned, so at most getLineIndexStride() lines are read.
+ * \param line The line, counted from 0.
+ * \return The offset, or the size of the capture if there is no such line.
+ */
+qint64 OutputCapture::getLineOffset(qint64 line) const {
+	QMutexLocker locker(&mutex);
+	if(line <= 0)
+		return 0;
+	if(line > newlineCount)
+		return totalSize;
+	qint64 entry = qMin<qint64>(line / lineIndexStride, lineIndex.size() - 1);
+	qint64 offset = lineIndex.at(entry);
+	qint64 remaining = line - entry * lineIndexStride;
+	static const int CHUNK = 64 * 1024;
+	while(remaining > 0 && offset < totalSize) {
+		QByteArray chunk = readLocked(offset, CHUNK);
+		const char* data = chunk.constData();
+		const char* end = data + chunk.size();
+		const char* newline = data;
+		while(remaining > 0 && (newline = static_cast<const char*>(memchr(newline, '\n', end - newline))) != 0) {
+			++newline;
+			--remaining;
+		}
+		offset += remaining > 0 ? chunk.size() : newline - data;
+	}
+	return offset;
+}
+
+/*! \brief Retrieves the line that a byte is on.
+ *
+ * The nearest indexed line before the byte is looked up and the newlines in
+ * between are counted, so at most getLineIndexStride() lines are read.
+ * \param offset The offset of the byte.
+ * \return The line, counted from 0.
+ */
+qint64 OutputCapture::getLineAt(qint64 offset) const {
+	QMutexLocker locker(&mutex);
+	if(offset <= 0)
+		return 0;
+	offset = qMin(offset, totalSize);
+	int entry = std::upper_bound(lineIndex.begin(), lineIndex.end(), offset) - lineIndex.begin() - 1;
+	qint64 line = (qint64)entry * lineIndexStride;
+	qint64 position = lineIndex.at(entry);
+	static const int CHUNK = 64 * 1024;
+	while(position < offset) {
+		QByteArray chunk = readLocked(position, (int)qMin<qint64>(CHUNK, offset - position));
+		if(chunk.isEmpty())
+			break;
+		const char* data = chunk.constData();
+		const char* end = data + chunk.size();
+		const char* newline = data;
+		while((newline = static_cast<const char*>(memchr(newline, '\n', end - newline))) != 0) {
+			++newline;
+			++line;
+		}
+		position += chunk.size();
+	}
+	return line;
+}
+
+/*! \brief Reads part of the captured output.
+ *
+ * \param offset The offset of the first byte to read.
+ * \param length The number of bytes to read.
+ * \return The bytes, which are fewer than 'length' past the end of the output.
+ */
+QByteArray OutputCapture::read(qint64 offset, int length) const {
+	QMutexLocker locker(&mutex);
+	return readLocked(offset, length);
+}
+
+/*! \brief Reads consecutive lines of the captured output.
+ *
+ * \param firstLine The first line to read, counted from 0.
+ * \param count The number of lines to read.
+ * \return The lines, each with its newline.
+ */
+QByteArray OutputCapture::readLines(qint64 firstLine, int count) const {
+	qint64 start = getLineOffset(firstLine);
+	qint64 end = getLineOffset(firstLine + count);
+	return read(start, end - start);
+}
+
+/*! \brief Reads part of the captured output with the mutex already held.
+ */
+QByteArray OutputCapture::readLocked(qint64 offset, int length) const {
+	QByteArray data;
+	if(offset < 0 || length <= 0 || offset >= totalSize)
+		return data;
+	length = (int)qMin<qint64>(length, totalSize - offset);
+	data.reserve(length);
+	if(offset < spilledSize) {
+		int spilled = (int)qMin<qint64>(length, spilledSize - offset);
+		if(spill && spill->isOpen() && spill->seek(offset))
+			data = spill->read(spilled);
+		if(data.size() < spilled) //bytes lost to a failed spill read as blanks
+			data.append(QByteArray(spilled - data.size(), ' '));
+		offset += spilled;
+		length -= spilled;
+	}
+	if(length > 0) {
+		const int ringSize = ring.size();
+		int position = (ringStart + (int)(offset - spilledSize)) % ringSize;
+		int firstPart = qMin(length, ringSize - position);
+		data.append(ring.constData() + position, firstPart);
+		data.append(ring.constData(), length - firstPart);
+	}
+	return data;
+}
@@ -0,0 +1,64 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * ResultArena.cpp - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "ResultArena.h"
+#include "GTestResults.h"
+
+/*! \brief Constructor
+ *
+ */
+ResultArena::ResultArena()
+: blocks(), blockUsed(0), objects()
+{}
+
+/*! \brief Destructor
+ *
+ * Releases the objects created in the arena.
+ */
+ResultArena::~ResultArena() {
+	release();
+}
+
+/*! \brief Allocates memory for an object from the last block, starting a new block if it is full.
+ *
+ * \param size The size of the object.
+ * \return The memory, aligned for any type.
+ */
+void* ResultArena::allocate(size_t size) {
+	static const size_t ALIGNMENT = 16;
+	size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+	if(blocks.isEmpty() || blockUsed + size > (size_t)BLOCK_SIZE) {
+		blocks.append(static_cast<char*>(::operator new(qMax<size_t>(BLOCK_SIZE, size))));
+		blockUsed = 0;
+	}
+	void* memory = blocks.last() + blockUsed;
+	blockUsed += size;
+	return memory;
+}
+
+/*! \brief Destroys every object created in the arena and frees its blocks.
+ *
+ * The objects are destroyed in the reverse order of their creation.
+ */
+void ResultArena::release() {
+	for(int i = objects.size() - 1; i >= 0; --i)
+		objects.at(i)->~GTestResults();
+	objects.clear();
+	foreach(char* block, blocks)
+		::operator delete(block);
+	blocks.clear();
+	blockUsed = 0;
+}
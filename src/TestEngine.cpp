@@ -0,0 +1,820 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * TestEngine.cpp - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "TestEngine.h"
+#include "GTestJsonParser.h"
+#include "GTestParser.h"
+#include "TestEventRecord.h"
+
+#include <QFile>
+#include <QFutureWatcher>
+#include <QHostAddress>
+#include <QProcessEnvironment>
+#include <QSocketNotifier>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QtConcurrentRun>
+
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+QAtomicInt TestEngine::nextJobId(1);
+
+/*! \brief Constructor
+ *
+ * Registers the types passed through the engine's queued signals.
+ */
+TestEngine::TestEngine(QObject* parent)
+: QObject(parent), jobs(), parseJobs(), parseJobIds(), jobIds(), channelJobs(), streamJobs(), finishTimers()
+{
+	qRegisterMetaType<TestEvent>("TestEvent");
+	qRegisterMetaType<QList<TestEvent> >("QList<TestEvent>");
+	qRegisterMetaType<TestListing>("TestListing");
+	qRegisterMetaType<GTestExecutableResults*>("GTestExecutableResults*");
+	qRegisterMetaType<OutputCapturePointer>("OutputCapturePointer");
+}
+
+/*! \brief Destructor
+ *
+ * Kills and deletes any process still running, and waits for the result
+ * files still being parsed so that their results can be released.
+ */
+TestEngine::~TestEngine() {
+	QHash<int, Job>::iterator it = jobs.begin();
+	for(; it != jobs.end(); ++it) {
+		it->process->disconnect(this);
+		it->process->kill();
+		it->process->waitForFinished(1000);
+		delete it->process;
+		closeChannel(*it);
+		closeStream(*it);
+	}
+	QObject* watcher;
+	foreach(watcher, parseJobIds.keys()) {
+		QFutureWatcher<GTestExecutableResults*>* resultWatcher = static_cast<QFutureWatcher<GTestExecutableResults*>*>(watcher);
+		resultWatcher->disconnect(this);
+		resultWatcher->waitForFinished();
+		delete resultWatcher->result();
+	}
+	QHash<int, ParseJob>::iterator parseIt = parseJobs.begin();
+	for(; parseIt != parseJobs.end(); ++parseIt)
+		delete parseIt->results;
+}
+
+/*! \brief Creates an id for a new job, unique across all engines.
+ *
+ * This may be called from any thread.
+ */
+int TestEngine::createJobId() {
+	return nextJobId.fetchAndAddRelaxed(1);
+}
+
+/*! \brief Starts listing the tests of an executable.
+ *
+ * listingFinished() is sent once the process has exited.
+ * \param job The id of the job, from createJobId().
+ * \param program The path of the gtest executable.
+ */
+void TestEngine::startListing(int job, QString program) {
+	startJob(job, true, program, QStringList() << "--gtest_list_tests", QStringList(),
+			 OutputCapturePointer(), OutputCapturePointer());
+}
+
+/*! \brief Parses a listing that has already been produced, e.g. a cached one.
+ *
+ * listingFinished() is sent as for a listing process that exited normally.
+ * \param job The id of the job, from createJobId().
+ * \param output The output of --gtest_list_tests.
+ */
+void TestEngine::parseListing(int job, QByteArray output) {
+	emit listingFinished(job, 0, QProcess::NormalExit, QProcess::UnknownError, parseListingOutput(output), output);
+}
+
+/*! \brief Starts a process running tests.
+ *
+ * testEvents() is sent as the tests progress and jobFinished() once the
+ * process has exited.
+ * \param job The id of the job, from createJobId().
+ * \param program The path of the gtest executable.
+ * \param arguments The command line arguments.
+ * \param environment Variables to add to the environment, as "NAME=value".
+ * \param standardOutput Where to capture the standard output of the process.
+ * \param standardError Where to capture the standard error of the process.
+ */
+void TestEngine::startTests(int job, QString program, QStringList arguments, QStringList environment,
+							OutputCapturePointer standardOutput, OutputCapturePointer standardError) {
+	startJob(job, false, program, arguments, environment, standardOutput, standardError);
+}
+
+/*! \brief Creates and starts the process of a job.
+ *
+ * A test process is given an event channel: a pipe whose write end it
+ * inherits. The engine is the only thread starting processes, so no other
+ * process can inherit the write end before it is closed here. It is also
+ * given a local port to stream its results to.
+ */
+void TestEngine::startJob(int id, bool listing, const QString& program, const QStringList& arguments, const QStringList& environment,
+						  OutputCapturePointer standardOutput, OutputCapturePointer standardError) {
+	Job job;
+	job.process = new QProcess(this);
+	job.listing = listing;
+	job.standardOutput = standardOutput ? standardOutput : OutputCapturePointer(new OutputCapture());
+	job.standardError = standardError ? standardError : OutputCapturePointer(new OutputCapture());
+	job.outputSize = 0;
+	job.partialLineOffset = 0;
+	job.outputTestStart = 0;
+	job.channel = -1;
+	job.channelNotifier = 0;
+	job.recordEvents = false;
+	job.streamServer = 0;
+	job.stream = 0;
+	job.streamEvents = false;
+	job.exitCode = -1;
+	job.exitStatus = QProcess::NormalExit;
+	job.finishTimer = 0;
+	int channelWriter = -1;
+#ifdef Q_OS_UNIX
+	int channel[2];
+	if(!listing && pipe(channel) == 0) {
+		fcntl(channel[0], F_SETFD, FD_CLOEXEC);
+		fcntl(channel[0], F_SETFL, O_NONBLOCK);
+		job.channel = channel[0];
+		channelWriter = channel[1];
+		job.channelNotifier = new QSocketNotifier(job.channel, QSocketNotifier::Read, this);
+		QObject::connect(job.channelNotifier, SIGNAL(activated(int)),
+						 this, SLOT(channelReadable(int)));
+		channelJobs.insert(job.channel, id);
+	}
+#endif
+	if(!environment.isEmpty() || channelWriter != -1) {
+		QProcessEnvironment processEnvironment = QProcessEnvironment::systemEnvironment();
+		QString variable;
+		foreach(variable, environment)
+			processEnvironment.insert(variable.section('=', 0, 0), variable.section('=', 1));
+		if(channelWriter != -1)
+			processEnvironment.insert(GTESTRUNNER_EVENT_FD, QString::number(channelWriter));
+		job.process->setProcessEnvironment(processEnvironment);
+	}
+	QStringList processArguments = arguments;
+	if(!listing) {
+		job.streamServer = new QTcpServer(this);
+		if(job.streamServer->listen(QHostAddress::LocalHost, 0)) {
+			QObject::connect(job.streamServer, SIGNAL(newConnection()),
+							 this, SLOT(streamConnected()));
+			streamJobs.insert(job.streamServer, id);
+			processArguments << QString("--gtest_stream_result_to=127.0.0.1:%1").arg(job.streamServer->serverPort());
+		}
+		else {
+			delete job.streamServer;
+			job.streamServer = 0;
+		}
+	}
+	QObject::connect(job.process, SIGNAL(readyReadStandardOutput()),
+					 this, SLOT(standardOutputAvailable()));
+	QObject::connect(job.process, SIGNAL(readyReadStandardError()),
+					 this, SLOT(standardErrorAvailable()));
+	QObject::connect(job.process, SIGNAL(finished(int, QProcess::ExitStatus)),
+					 this, SLOT(processFinished(int, QProcess::ExitStatus)));
+	QObject::connect(job.process, SIGNAL(error(QProcess::ProcessError)),
+					 this, SLOT(processError(QProcess::ProcessError)));
+	jobs.insert(id, job);
+	jobIds.insert(job.process, id);
+	job.process->start(program, processArguments);
+#ifdef Q_OS_UNIX
+	if(channelWriter != -1)
+		close(channelWriter); //the child has its own copy once started
+#endif
+}
+
+/*! \brief Kills the process of a job.
+ *
+ * The job still finishes as usual, with a crashed exit status.
+ */
+void TestEngine::kill(int job) {
+	if(jobs.contains(job))
+		jobs.value(job).process->kill();
+}
+
+/*! \brief Slot that is called when stdout data is available from a process.
+ */
+void TestEngine::standardOutputAvailable() {
+	QProcess* process = qobject_cast<QProcess*>(sender());
+	if(!jobIds.contains(process))
+		return;
+	int id = jobIds.value(process);
+	Job& job = jobs[id];
+	pollStream(id, job);
+	QList<TestEvent> events = readStandardOutput(job);
+	if(!events.isEmpty())
+		emit testEvents(id, events);
+}
+
+/*! \brief Slot that is called when stderr data is available from a process.
+ */
+void TestEngine::standardErrorAvailable() {
+	QProcess* process = qobject_cast<QProcess*>(sender());
+	if(!jobIds.contains(process))
+		return;
+	jobs[jobIds.value(process)].standardError->append(process->readAllStandardError());
+}
+
+/*! \brief Reads the standard output available from a job's process.
+ *
+ * A listing is kept whole, to be parsed once the process exits. The output
+ * of a test process is scanned for test progress as it is read and then
+ * handed to its capture, which keeps memory bounded however much it prints.
+ * \return The progress found in the output.
+ */
+QList<TestEvent> TestEngine::readStandardOutput(Job& job) {
+	QByteArray chunk = job.process->readAllStandardOutput();
+	if(job.listing) {
+		job.output.append(chunk);
+		return QList<TestEvent>();
+	}
+	QList<TestEvent> events = scanOutput(job, chunk);
+	job.standardOutput->append(chunk);
+	return events;
+}
+
+/*! \brief Scans a chunk of a job's output for test progress.
+ *
+ * gtest reports progress with lines such as "[ RUN      ] suite.test" and
+ * "[       OK ] suite.test (3 ms)". The chunk is scanned in place: memchr()
+ * finds the end of each line and the markers are compared with memcmp(), so
+ * nothing is copied or converted except the names of the tests found. Only
+ * the start of a line left unfinished at the end of the chunk is kept until
+ * the rest of it is read.
+ * \return The progress found in the lines completed by the chunk.
+ */
+QList<TestEvent> TestEngine::scanOutput(Job& job, const QByteArray& chunk) {
+	//The markers start their lines, so the start of a line is all that's needed.
+	static const int MAX_PARTIAL_LINE = 4096;
+	QList<TestEvent> events;
+	const char* data = chunk.constData();
+	const char* end = data + chunk.size();
+	const char* line = data;
+	const char* newline;
+	qint64 base = job.outputSize;
+	job.outputSize += chunk.size();
+	if(!job.partialLine.isEmpty()) {
+		newline = static_cast<const char*>(memchr(data, '\n', chunk.size()));
+		int length = newline ? newline - data : chunk.size();
+		job.partialLine.append(data, qMin(length, qMax(0, MAX_PARTIAL_LINE - job.partialLine.size())));
+		if(!newline)
+			return events;
+		scanLine(job, job.partialLine.constData(), job.partialLine.constData() + job.partialLine.size(),
+				 job.partialLineOffset, base + (newline - data) + 1, events);
+		job.partialLine.clear();
+		line = newline + 1;
+	}
+	while((newline = static_cast<const char*>(memchr(line, '\n', end - line))) != 0) {
+		scanLine(job, line, newline, base + (line - data), base + (newline - data) + 1, events);
+		line = newline + 1;
+	}
+	if(line < end) {
+		job.partialLine = QByteArray(line, qMin<int>(end - line, MAX_PARTIAL_LINE));
+		job.partialLineOffset = base + (line - data);
+	}
+	return events;
+}
+
+/*! \brief Adds the progress reported by a complete line of a job's output.
+ *
+ * The start of a test's "[ RUN      ]" line and the end of its result line
+ * bound the test's output, which is reported as an OUTPUT event. The
+ * progress itself is only taken from the output of a process that reports
+ * it neither on its event channel nor on its result stream.
+ * \param lineStart The offset of the line in the standard output.
+ * \param lineEnd The offset just past the line's newline.
+ */
+void TestEngine::scanLine(Job& job, const char* line, const char* end, qint64 lineStart, qint64 lineEnd, QList<TestEvent>& events) {
+	TestEvent event;
+	if(!scanLine(line, end, &event))
+		return;
+	if(event.type == TestEvent::BEGIN) {
+		job.outputTest = event.name;
+		job.outputTestStart = lineStart;
+	}
+	if(!job.recordEvents && !job.streamEvents)
+		events << event;
+	if(event.type != TestEvent::BEGIN && event.name == job.outputTest) {
+		TestEvent output;
+		output.type = TestEvent::OUTPUT;
+		output.name = job.outputTest;
+		output.outputStart = job.outputTestStart;
+		output.outputEnd = lineEnd;
+		events << output;
+		job.outputTest.clear();
+	}
+}
+
+/*! \brief Reads the progress reported by a single line of gtest output.
+ *
+ * \param line The start of the line.
+ * \param end The end of the line, excluding the newline.
+ * \param event Set to the progress if the line reports any.
+ * \return true if the line starts with one of the progress markers.
+ */
+bool TestEngine::scanLine(const char* line, const char* end, TestEvent* event) {
+	static const int MARKER_LENGTH = 12;
+	if(end - line <= MARKER_LENGTH || line[0] != '[')
+		return false;
+	if(memcmp(line, "[ RUN      ]", MARKER_LENGTH) == 0)
+		event->type = TestEvent::BEGIN;
+	else if(memcmp(line, "[       OK ]", MARKER_LENGTH) == 0)
+		event->type = TestEvent::PASSED;
+	else if(memcmp(line, "[  FAILED  ]", MARKER_LENGTH) == 0)
+		event->type = TestEvent::FAILED;
+	else
+		return false;
+	const char* name = line + MARKER_LENGTH;
+	while(name < end && *name == ' ')
+		++name;
+	const char* nameEnd = name;
+	// parametrized failures are followed by ", where GetParam() = ..."
+	while(nameEnd < end && *nameEnd != ' ' && *nameEnd != ',' && *nameEnd != '\r')
+		++nameEnd;
+	event->name = QString::fromUtf8(name, nameEnd - name);
+	return true;
+}
+
+/*! \brief Slot that is called when a process has exited.
+ */
+void TestEngine::processFinished(int exitCode, QProcess::ExitStatus exitStatus) {
+	QProcess* process = qobject_cast<QProcess*>(sender());
+	if(jobIds.contains(process))
+		finishJob(jobIds.value(process), exitCode, exitStatus);
+}
+
+/*! \brief Slot that is called when a process has an error.
+ *
+ * A process that fails to start never finishes, so its job is finished here.
+ */
+void TestEngine::processError(QProcess::ProcessError error) {
+	QProcess* process = qobject_cast<QProcess*>(sender());
+	if(error == QProcess::FailedToStart && jobIds.contains(process))
+		finishJob(jobIds.value(process), -1, QProcess::CrashExit);
+}
+
+/*! \brief Reads the events a job's process left on its channel once it has exited.
+ *
+ * The job is completed at once, unless the process streams its results and
+ * the stream is still connected. Its last events may then still be on their
+ * way, so the job is completed once the stream is closed, or once
+ * STREAM_CLOSE_TIMEOUT has passed if it never is.
+ */
+void TestEngine::finishJob(int id, int exitCode, QProcess::ExitStatus exitStatus) {
+	Job& job = jobs[id];
+	jobIds.remove(job.process);
+	job.exitCode = exitCode;
+	job.exitStatus = exitStatus;
+	//The process has exited, so whatever it wrote to its channel can be read.
+	QList<TestEvent> events = readRecords(job);
+	closeChannel(job);
+	pollStream(id, job);
+	if(!events.isEmpty())
+		emit testEvents(id, events);
+	if(!job.stream || job.stream->state() != QAbstractSocket::ConnectedState) {
+		completeJob(id);
+		return;
+	}
+	QObject::connect(job.stream, SIGNAL(disconnected()), this, SLOT(streamDisconnected()));
+	job.finishTimer = new QTimer(this);
+	job.finishTimer->setSingleShot(true);
+	QObject::connect(job.finishTimer, SIGNAL(timeout()), this, SLOT(finishTimeout()));
+	finishTimers.insert(job.finishTimer, id);
+	job.finishTimer->start(STREAM_CLOSE_TIMEOUT);
+}
+
+/*! \brief Reads what remains of a finished job's output, sends its results and deletes its process.
+ */
+void TestEngine::completeJob(int id) {
+	Job job = jobs.take(id);
+	QList<TestEvent> events = readStream(job);
+	closeStream(job);
+	events += readStandardOutput(job);
+	job.standardError->append(job.process->readAllStandardError());
+	if(!job.partialLine.isEmpty()) {
+		scanLine(job, job.partialLine.constData(), job.partialLine.constData() + job.partialLine.size(),
+				 job.partialLineOffset, job.outputSize, events);
+		job.partialLine.clear();
+	}
+	if(!job.outputTest.isEmpty()) {
+		//The test didn't finish, most likely it crashed; its output runs to the end.
+		TestEvent output;
+		output.type = TestEvent::OUTPUT;
+		output.name = job.outputTest;
+		output.outputStart = job.outputTestStart;
+		output.outputEnd = job.outputSize;
+		events << output;
+	}
+	if(!events.isEmpty())
+		emit testEvents(id, events);
+	QProcess::ProcessError error = job.process->error();
+	job.process->disconnect(this);
+	job.process->deleteLater();
+
+	if(job.listing)
+		emit listingFinished(id, job.exitCode, job.exitStatus, error, parseListingOutput(job.output), job.output);
+	else
+		emit jobFinished(id, job.exitCode, job.exitStatus, error);
+}
+
+/*! \brief Slot that is called when an exited process's result stream hasn't closed in time.
+ */
+void TestEngine::finishTimeout() {
+	QObject* timer = sender();
+	if(finishTimers.contains(timer))
+		completeJob(finishTimers.value(timer));
+}
+
+/*! \brief Slot that is called when records can be read from an event channel.
+ */
+void TestEngine::channelReadable(int channel) {
+	if(!channelJobs.contains(channel))
+		return;
+	int id = channelJobs.value(channel);
+	QList<TestEvent> events = readRecords(jobs[id]);
+	if(!events.isEmpty())
+		emit testEvents(id, events);
+}
+
+/*! \brief Reads the records available on a job's event channel.
+ *
+ * Once the first record arrives the job's progress is taken from its
+ * channel alone, and its console output is no longer scanned. A record of
+ * another version or of an impossible size drops the channel, and the
+ * job's progress is taken from its console output again.
+ * \return The progress reported by the complete records read.
+ */
+QList<TestEvent> TestEngine::readRecords(Job& job) {
+	QList<TestEvent> events;
+#ifdef Q_OS_UNIX
+	if(job.channel == -1)
+		return events;
+	char buffer[4096];
+	for(;;) {
+		ssize_t count = read(job.channel, buffer, sizeof(buffer));
+		if(count < 0 && errno == EINTR)
+			continue;
+		if(count <= 0) {
+			if(count == 0 && job.channelNotifier)
+				job.channelNotifier->setEnabled(false); //every writer has closed the channel
+			break;
+		}
+		job.records.append(buffer, count);
+	}
+
+	const int headerSize = sizeof(TestEventRecord);
+	int offset = 0;
+	while(job.records.size() - offset >= headerSize) {
+		TestEventRecord record;
+		memcpy(&record, job.records.constData() + offset, headerSize);
+		qint64 recordSize = (qint64)headerSize + record.nameLength + record.fileLength;
+		if(record.type == TEST_FAILURE_RECORD)
+			recordSize += record.messageLength;
+		if(record.magic != TEST_EVENT_RECORD_MAGIC || record.version != TEST_EVENT_RECORD_VERSION
+				|| recordSize > TEST_EVENT_RECORD_MAX_SIZE) {
+			//An incompatible listener or a garbled channel; fall back on the console output.
+			job.records.clear();
+			job.recordEvents = false;
+			closeChannel(job);
+			return events;
+		}
+		int size = (int)recordSize;
+		if(job.records.size() - offset < size)
+			break;
+		const char* name = job.records.constData() + offset + headerSize;
+		TestEvent event;
+		event.name = QString::fromUtf8(name, record.nameLength);
+		switch(record.type) {
+		case TEST_START_RECORD:
+			event.type = TestEvent::BEGIN;
+			break;
+		case TEST_END_RECORD:
+			event.type = record.failed ? TestEvent::FAILED : TestEvent::PASSED;
+			event.duration = record.duration;
+			break;
+		case TEST_FAILURE_RECORD:
+			event.type = TestEvent::FAILURE;
+			event.file = QString::fromUtf8(name + record.nameLength, record.fileLength);
+			event.line = record.line;
+			event.message = QString::fromUtf8(name + record.nameLength + record.fileLength, record.messageLength);
+			break;
+		default:
+			offset += size;
+			continue;
+		}
+		events << event;
+		offset += size;
+	}
+	job.records.remove(0, offset);
+	if(offset > 0)
+		job.recordEvents = true;
+#else
+	Q_UNUSED(job);
+#endif
+	return events;
+}
+
+/*! \brief Closes a job's event channel, if it has one.
+ */
+void TestEngine::closeChannel(Job& job) {
+	if(job.channel == -1)
+		return;
+	channelJobs.remove(job.channel);
+	//The channel may be closed from the notifier's own activated() signal.
+	if(job.channelNotifier) {
+		job.channelNotifier->setEnabled(false);
+		job.channelNotifier->deleteLater();
+	}
+	job.channelNotifier = 0;
+#ifdef Q_OS_UNIX
+	close(job.channel);
+#endif
+	job.channel = -1;
+}
+
+/*! \brief Slot that is called when a process connects to its result stream server.
+ */
+void TestEngine::streamConnected() {
+	QObject* server = sender();
+	if(!streamJobs.contains(server))
+		return;
+	int id = streamJobs.value(server);
+	acceptStream(id, jobs[id]);
+}
+
+/*! \brief Slot that is called when the result stream of an exited process is closed.
+ */
+void TestEngine::streamDisconnected() {
+	QObject* stream = sender();
+	if(streamJobs.contains(stream))
+		completeJob(streamJobs.value(stream));
+}
+
+/*! \brief Accepts a job's result stream if its process has connected to it.
+ *
+ * The connection is polled for rather than waited for, as the process may
+ * have connected and written its first lines of output before the server's
+ * newConnection() signal is delivered.
+ */
+void TestEngine::pollStream(int id, Job& job) {
+	if(!job.streamServer || job.stream)
+		return;
+	if(!job.streamServer->hasPendingConnections())
+		job.streamServer->waitForNewConnection(0);
+	if(!job.stream && job.streamServer->hasPendingConnections())
+		acceptStream(id, job);
+}
+
+/*! \brief Accepts the connection of a job's result stream.
+ *
+ * The server stops listening, as a process streams its results on a single
+ * connection. From then on the progress is taken from the stream, so that
+ * none of it is reported twice from the console output as well.
+ */
+void TestEngine::acceptStream(int id, Job& job) {
+	job.stream = job.streamServer->nextPendingConnection();
+	if(!job.stream)
+		return;
+	job.streamEvents = true;
+	job.stream->setParent(this);
+	streamJobs.remove(job.streamServer);
+	job.streamServer->close();
+	streamJobs.insert(job.stream, id);
+	QObject::connect(job.stream, SIGNAL(readyRead()), this, SLOT(streamReadable()));
+}
+
+/*! \brief Slot that is called when events can be read from a result stream.
+ */
+void TestEngine::streamReadable() {
+	QObject* stream = sender();
+	if(!streamJobs.contains(stream))
+		return;
+	int id = streamJobs.value(stream);
+	QList<TestEvent> events = readStream(jobs[id]);
+	if(!events.isEmpty())
+		emit testEvents(id, events);
+}
+
+/*! \brief Reads the complete event lines available on a job's result stream.
+ *
+ * The stream is ignored if the process also reports on its event channel.
+ * \return The progress reported by the lines read.
+ */
+QList<TestEvent> TestEngine::readStream(Job& job) {
+	QList<TestEvent> events;
+	if(!job.stream)
+		return events;
+	while(job.stream->canReadLine()) {
+		QByteArray line = job.stream->readLine();
+		if(job.recordEvents)
+			continue;
+		TestEvent event;
+		if(parseStreamLine(line, job, &event))
+			events << event;
+	}
+	return events;
+}
+
+/*! \brief Parses a line of gtest's result stream.
+ *
+ * Each line is an event such as "event=TestEnd&passed=1&elapsed_time=3ms",
+ * with its values percent-encoded. The test events only give the test's own
+ * name, so the suite and test the stream is in are tracked in the job.
+ * \param line The line, with or without its newline.
+ * \param job The job the stream belongs to.
+ * \param event Set to the progress if the line reports any.
+ * \return true if the line reports the progress of a test.
+ */
+bool TestEngine::parseStreamLine(const QByteArray& line, Job& job, TestEvent* event) {
+	QHash<QByteArray, QByteArray> fields;
+	QByteArray field;
+	foreach(field, line.trimmed().split('&')) {
+		int separator = field.indexOf('=');
+		if(separator != -1)
+			fields.insert(field.left(separator), QByteArray::fromPercentEncoding(field.mid(separator + 1)));
+	}
+	QByteArray type = fields.value("event");
+	if(type == "TestCaseStart" || type == "TestSuiteStart") {
+		job.streamSuite = QString::fromUtf8(fields.value("name"));
+		return false;
+	}
+	if(type == "TestStart") {
+		job.streamTest = job.streamSuite + '.' + QString::fromUtf8(fields.value("name"));
+		event->type = TestEvent::BEGIN;
+	}
+	else if(type == "TestPartResult") {
+		event->type = TestEvent::FAILURE;
+		event->file = QString::fromUtf8(fields.value("file"));
+		event->line = fields.value("line").toInt();
+		event->message = QString::fromUtf8(fields.value("message"));
+	}
+	else if(type == "TestEnd") {
+		event->type = fields.value("passed") == "1" ? TestEvent::PASSED : TestEvent::FAILED;
+		QByteArray elapsed = fields.value("elapsed_time");
+		if(elapsed.endsWith("ms"))
+			elapsed.chop(2);
+		bool ok;
+		int duration = elapsed.toInt(&ok);
+		if(ok)
+			event->duration = duration;
+	}
+	else {
+		return false;
+	}
+	if(job.streamTest.isEmpty())
+		return false;
+	event->name = job.streamTest;
+	if(type == "TestEnd")
+		job.streamTest.clear();
+	return true;
+}
+
+/*! \brief Closes a job's result stream and its server, if it has them.
+ */
+void TestEngine::closeStream(Job& job) {
+	if(job.finishTimer) {
+		finishTimers.remove(job.finishTimer);
+		job.finishTimer->disconnect(this);
+		job.finishTimer->deleteLater();
+		job.finishTimer = 0;
+	}
+	if(job.streamServer) {
+		streamJobs.remove(job.streamServer);
+		delete job.streamServer;
+		job.streamServer = 0;
+	}
+	if(job.stream) {
+		streamJobs.remove(job.stream);
+		job.stream->disconnect(this);
+		job.stream->deleteLater();
+		job.stream = 0;
+	}
+}
+
+/*! \brief Parses the output of --gtest_list_tests.
+ *
+ * Suites are listed as "suitename." followed by their tests, indented.
+ * The comments gtest adds to parametrized and typed tests are removed, as
+ * only the names appear in the results.
+ */
+TestListing TestEngine::parseListingOutput(const QByteArray& output) {
+	TestListing listing;
+	int start = 0;
+	while(start < output.size()) {
+		int end = output.indexOf('\n', start);
+		if(end == -1)
+			end = output.size();
+		QString name = QString::fromUtf8(output.constData() + start, end - start).trimmed();
+		start = end + 1;
+
+		//Parametrized and typed tests have a comment that start with #
+		int indexOf = name.indexOf('#');
+		if(0 < indexOf)
+			name = name.left(indexOf).trimmed();
+		if(name.isEmpty())
+			continue;
+
+		if(name.endsWith('.')) {	//this means its a test suite name
+			name.chop(1);
+			listing << qMakePair(name, QStringList());
+		}
+		else if(!listing.isEmpty()) {
+			//We should always run into 'testsuitename.'
+			//before we hit a unit test name.
+			listing.last().second << name;
+		}
+	}
+	return listing;
+}
+
+/*! \brief Parses the result files of a run and merges them.
+ *
+ * Each file is parsed by a task of its own on the global QThreadPool, and
+ * the results are merged on the engine's thread as the tasks complete.
+ * resultsParsed() is sent once every file has been parsed, with the merged
+ * results, or null if no file could be parsed. As each run is a job of its
+ * own, the runs whose files are parsed together are handed back in the
+ * order they complete. Missing files are skipped, as a shard with no tests
+ * to run may not write one.
+ * \param job The id of the job, from createJobId().
+ * \param paths The result files written by the run's processes.
+ */
+void TestEngine::parseResults(int job, QStringList paths) {
+	ParseJob parseJob = { 0, 0 };
+	QString path;
+	foreach(path, paths) {
+		if(!QFile::exists(path))
+			continue;
+		QFutureWatcher<GTestExecutableResults*>* watcher = new QFutureWatcher<GTestExecutableResults*>(this);
+		connect(watcher, SIGNAL(finished()), this, SLOT(resultFileParsed()));
+		parseJobIds.insert(watcher, job);
+		watcher->setFuture(QtConcurrent::run(&TestEngine::parseResultFile, path));
+		++parseJob.pending;
+	}
+	if(parseJob.pending == 0)
+		emit resultsParsed(job, 0);
+	else
+		parseJobs.insert(job, parseJob);
+}
+
+/*! \brief Parses a result file.
+ *
+ * This runs on the thread pool. Files ending in .json are parsed as
+ * gtest's JSON output, any others as its XML output.
+ * \param path The result file.
+ * \return The results of the file, or null if it couldn't be parsed.
+ */
+GTestExecutableResults* TestEngine::parseResultFile(const QString& path) {
+	QFile file(path);
+	if(path.endsWith(".json"))
+		return GTestJsonParser(&file).parse();
+	return GTestParser(&file).parse();
+}
+
+/*! \brief Slot that is called when a result file has been parsed.
+ *
+ * Its results are merged into those of its run, which are sent with
+ * resultsParsed() once the run's last file has been parsed.
+ */
+void TestEngine::resultFileParsed() {
+	QFutureWatcher<GTestExecutableResults*>* watcher = static_cast<QFutureWatcher<GTestExecutableResults*>*>(sender());
+	if(!parseJobIds.contains(watcher))
+		return;
+	int id = parseJobIds.take(watcher);
+	GTestExecutableResults* fileResults = watcher->result();
+	watcher->deleteLater();
+	ParseJob& parseJob = parseJobs[id];
+	if(fileResults) {
+		if(!parseJob.results)
+			parseJob.results = fileResults;
+		else
+			parseJob.results->merge(fileResults);
+	}
+	if(--parseJob.pending == 0) {
+		GTestExecutableResults* results = parseJob.results;
+		parseJobs.remove(id);
+		emit resultsParsed(id, results);
+	}
+}
@@ -0,0 +1,177 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * TestHistory.cpp - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "TestHistory.h"
+#include "GTestExecutableResults.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QTextStream>
+
+/*! \brief Constructor
+ *
+ * The history is loaded from 'filePath' if it exists.
+ * \param filePath The file to keep the history in. If empty, the file
+ * 		  test_durations.txt in the user's cache directory is used.
+ */
+TestHistory::TestHistory(QString filePath)
+: filePath(filePath), durations(), totalDuration(0), totalCount(0), modified(false)
+{
+	if(this->filePath.isEmpty())
+		this->filePath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+						 + "/test_durations.txt";
+	load();
+}
+
+/*! \brief Destructor
+ *
+ */
+TestHistory::~TestHistory()
+{}
+
+/*! \brief Retrieves the recorded duration of a test.
+ *
+ * \param executable The path of the executable the test belongs to.
+ * \param testName The name of the test in the form "suite.test".
+ * \return The duration in seconds, or -1 if the test has never been run.
+ */
+double TestHistory::getDuration(const QString& executable, const QString& testName) const {
+	return durations.value(executable).value(testName, -1);
+}
+
+/*! \brief Estimates how long a test will take to run.
+ *
+ * Tests that have been run before are estimated by their recorded duration.
+ * Other tests are given the mean duration of all recorded tests so that they
+ * are split equally with each other. If nothing has been recorded at all,
+ * every test is estimated at one second, which also results in equal splits.
+ * \param executable The path of the executable the test belongs to.
+ * \param testName The name of the test in the form "suite.test".
+ * \return The estimated duration in seconds.
+ */
+double TestHistory::estimate(const QString& executable, const QString& testName) const {
+	double duration = getDuration(executable, testName);
+	if(duration >= 0)
+		return duration;
+	if(totalCount > 0)
+		return totalDuration / totalCount;
+	return 1;
+}
+
+/*! \brief Records a new duration for the test.
+ *
+ * The duration is averaged with the previously recorded one so that a single
+ * slow or fast run doesn't skew the estimate.
+ * \param executable The path of the executable the test belongs to.
+ * \param testName The name of the test in the form "suite.test".
+ * \param seconds The running time of the test.
+ */
+void TestHistory::record(const QString& executable, const QString& testName, double seconds) {
+	if(seconds < 0)
+		return;
+	modified = true;
+	QHash<QString, double>& tests = durations[executable];
+	QHash<QString, double>::iterator it = tests.find(testName);
+	if(it == tests.end()) {
+		tests.insert(testName, seconds);
+		totalDuration += seconds;
+		++totalCount;
+		return;
+	}
+	double smoothed = (it.value() + seconds) / 2;
+	totalDuration += smoothed - it.value();
+	it.value() = smoothed;
+}
+
+/*! \brief Records the duration of every test in the results.
+ *
+ * Tests that weren't run (e.g. disabled tests) are ignored.
+ * \param executable The path of the executable the results belong to.
+ * \param results The results of a run of the executable.
+ */
+void TestHistory::recordResults(const QString& executable, GTestExecutableResults* results) {
+	if(!results)
+		return;
+	GTestResults* suite;
+	foreach(suite, results->getTestResultsList()) {
+		GTestSuiteResults* suiteResults = dynamic_cast<GTestSuiteResults*>(suite);
+		if(!suiteResults)
+			continue;
+		QString prefix = suiteResults->getName() + ".";
+		GTestResults* test;
+		foreach(test, suiteResults->getTestResultsList()) {
+			if(test->getStatus() == GTestResults::NOTRUN)
+				continue;
+			if(test->getTime() >= 0)
+				record(executable, prefix + test->getName(), test->getTime());
+		}
+	}
+}
+
+/*! \brief Loads the history from its file.
+ *
+ * Each line of the file holds the executable path, the test name and its
+ * duration in seconds, separated by tabs.
+ * \return true if the file was read, false if it couldn't be opened.
+ */
+bool TestHistory::load() {
+	QFile file(filePath);
+	if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+		return false;
+	durations.clear();
+	totalDuration = 0;
+	totalCount = 0;
+	QTextStream stream(&file);
+	while(!stream.atEnd()) {
+		QStringList fields = stream.readLine().split('\t');
+		if(fields.size() != 3)
+			continue;
+		bool ok;
+		double seconds = fields.at(2).toDouble(&ok);
+		if(ok)
+			record(fields.at(0), fields.at(1), seconds);
+	}
+	modified = false;
+	return true;
+}
+
+/*! \brief Saves the history to its file.
+ *
+ * The history is written to a temporary file that then replaces the file,
+ * so that the previous history survives a save that fails or is interrupted.
+ * \return true if the file was written, false otherwise.
+ */
+bool TestHistory::save() {
+	QDir().mkpath(QFileInfo(filePath).absolutePath());
+	QSaveFile file(filePath);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+		return false;
+	QTextStream stream(&file);
+	QHash<QString, QHash<QString, double> >::const_iterator exe = durations.constBegin();
+	for(; exe != durations.constEnd(); ++exe) {
+		QHash<QString, double>::const_iterator test = exe.value().constBegin();
+		for(; test != exe.value().constEnd(); ++test)
+			stream << exe.key() << '\t' << test.key() << '\t' << test.value() << '\n';
+	}
+	stream.flush();
+	if(!file.commit())
+		return false;
+	modified = false;
+	return true;
+}
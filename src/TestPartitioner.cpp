@@ -0,0 +1,180 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * TestPartitioner.cpp - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "TestPartitioner.h"
+
+#include <algorithm>
+
+/*! \brief The maximum number of refinements made after the greedy placement.
+ */
+static const int MAX_REFINEMENTS = 100;
+
+/*! \brief The largest number of test pairs considered for a swap in one refinement.
+ *
+ * With many tests per shard the greedy placement is already close to optimal,
+ * so only single moves are tried to keep the refinement cheap.
+ */
+static const int MAX_SWAP_CANDIDATES = 100000;
+
+/*! \brief Constructor
+ *
+ * \param binCount The number of shards to split the tests into, at least 1.
+ */
+TestPartitioner::TestPartitioner(int binCount)
+: items(), bins(), loads()
+{
+	for(int i = 0; i < qMax(1, binCount); ++i) {
+		bins.append(QList<Item>());
+		loads.append(0);
+	}
+}
+
+/*! \brief Destructor
+ *
+ */
+TestPartitioner::~TestPartitioner()
+{}
+
+/*! \brief Adds a test to be partitioned.
+ *
+ * \param name The name of the test in the form "suite.test".
+ * \param estimate The estimated running time of the test in seconds.
+ */
+void TestPartitioner::addTest(const QString& name, double estimate) {
+	Item item = { name, qMax(0.0, estimate) };
+	items.append(item);
+}
+
+/*! \brief Orders items from the longest to the shortest estimate.
+ */
+bool TestPartitioner::longerThan(const Item& a, const Item& b) {
+	return a.estimate > b.estimate;
+}
+
+/*! \brief Retrieves the index of the shard with the largest estimate.
+ */
+int TestPartitioner::heaviestBin() const {
+	int heaviest = 0;
+	for(int i = 1; i < loads.size(); ++i)
+		if(loads.at(i) > loads.at(heaviest))
+			heaviest = i;
+	return heaviest;
+}
+
+/*! \brief Retrieves the index of the shard with the smallest estimate.
+ *
+ * Of equally loaded shards, the one with the fewest tests is chosen, so
+ * that tests estimated at zero seconds are still spread across the shards.
+ */
+int TestPartitioner::lightestBin() const {
+	int lightest = 0;
+	for(int i = 1; i < loads.size(); ++i)
+		if(loads.at(i) < loads.at(lightest)
+		   || (loads.at(i) == loads.at(lightest) && bins.at(i).size() < bins.at(lightest).size()))
+			lightest = i;
+	return lightest;
+}
+
+/*! \brief Splits the added tests into the shards.
+ *
+ * The tests are first placed longest first into the least loaded shard
+ * (longest processing time first), which is within a third of the optimal
+ * makespan. Then refine() is applied until it can no longer improve it.
+ */
+void TestPartitioner::partition() {
+	for(int i = 0; i < bins.size(); ++i) {
+		bins[i].clear();
+		loads[i] = 0;
+	}
+	QList<Item> sorted = items;
+	std::stable_sort(sorted.begin(), sorted.end(), longerThan);
+	Item item;
+	foreach(item, sorted) {
+		int bin = lightestBin();
+		bins[bin].append(item);
+		loads[bin] += item.estimate;
+	}
+	for(int i = 0; i < MAX_REFINEMENTS && refine(); ++i)
+		;
+}
+
+/*! \brief Shortens the most loaded shard by one move or swap, if possible.
+ *
+ * A test is moved from the most loaded shard to the least loaded one, or
+ * swapped with a shorter test of the least loaded one, choosing the change
+ * that brings the two shards closest to equal.
+ * \return true if the makespan was shortened, false otherwise.
+ */
+bool TestPartitioner::refine() {
+	int heavy = heaviestBin();
+	int light = lightestBin();
+	if(heavy == light)
+		return false;
+	double gap = loads.at(heavy) - loads.at(light);
+	//Moving a total of 'delta' from heavy to light improves things when 0 < delta < gap.
+	//The best change moves as close as possible to gap / 2.
+	double bestDelta = 0;
+	int bestHeavy = -1;
+	int bestLight = -1;
+	const QList<Item>& heavyItems = bins.at(heavy);
+	const QList<Item>& lightItems = bins.at(light);
+	bool trySwaps = heavyItems.size() * lightItems.size() <= MAX_SWAP_CANDIDATES;
+	for(int i = 0; i < heavyItems.size(); ++i) {
+		double delta = heavyItems.at(i).estimate;
+		if(delta > 0 && delta < gap && qAbs(gap / 2 - delta) < qAbs(gap / 2 - bestDelta)) {
+			bestDelta = delta;
+			bestHeavy = i;
+			bestLight = -1;
+		}
+		for(int j = 0; trySwaps && j < lightItems.size(); ++j) {
+			delta = heavyItems.at(i).estimate - lightItems.at(j).estimate;
+			if(delta > 0 && delta < gap && qAbs(gap / 2 - delta) < qAbs(gap / 2 - bestDelta)) {
+				bestDelta = delta;
+				bestHeavy = i;
+				bestLight = j;
+			}
+		}
+	}
+	if(bestHeavy < 0)
+		return false;
+	Item moved = bins[heavy].takeAt(bestHeavy);
+	bins[light].append(moved);
+	if(bestLight >= 0)
+		bins[heavy].append(bins[light].takeAt(bestLight));
+	loads[heavy] -= bestDelta;
+	loads[light] += bestDelta;
+	return true;
+}
+
+/*! \brief Retrieves the estimated running time of the longest shard.
+ */
+double TestPartitioner::getMakespan() const {
+	return loads.value(heaviestBin());
+}
+
+/*! \brief Retrieves the tests assigned to a shard.
+ *
+ * This is only meaningful after partition() has been called.
+ * \param bin The index of the shard.
+ * \return The names of the shard's tests in the form "suite.test".
+ */
+QStringList TestPartitioner::getTests(int bin) const {
+	QStringList tests;
+	Item item;
+	foreach(item, bins.value(bin))
+		tests << item.name;
+	return tests;
+}
@@ -0,0 +1,199 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * TestScheduler.cpp - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "TestScheduler.h"
+#include "GTestExecutable.h"
+
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+
+/*! \brief Orders run units from the longest to the shortest estimate.
+ */
+static bool longerThan(const RunUnit& a, const RunUnit& b) {
+	return a.estimate > b.estimate;
+}
+
+/*! \brief Constructor
+ *
+ * The scheduler starts with one process slot per core.
+ * \param parent The parent QObject.
+ */
+TestScheduler::TestScheduler(QObject* parent)
+: QObject(parent), maxProcesses(qMax(1, QThread::idealThreadCount())),
+  runningProcesses(0), dispatchPending(false), executables(), backlog(), launched()
+{}
+
+/*! \brief Destructor
+ *
+ */
+TestScheduler::~TestScheduler()
+{}
+
+/*! \brief Sets the maximum number of processes to keep running at once.
+ *
+ * If the limit is raised, queued units are started on the next pass
+ * through the event loop. Lowering it never stops running processes.
+ * \param maxProcesses The new limit, values below 1 are clamped to 1.
+ */
+void TestScheduler::setMaxProcesses(int maxProcesses) {
+	this->maxProcesses = qMax(1, maxProcesses);
+	scheduleDispatch();
+}
+
+/*! \brief Queues the run units of an executable.
+ *
+ * The units are numbered 0 to estimates.size()-1 and are handed back to the
+ * executable through GTestExecutable::launchShard(). The executable must
+ * emit shardFinished() once for every unit that has been launched.
+ * Units are not started immediately, so that every executable asked
+ * to run in the same pass of the event loop is considered together.
+ * \param executable The executable the units belong to.
+ * \param estimates The estimated running time of each unit in seconds.
+ */
+void TestScheduler::submit(GTestExecutable* executable, const QList<double>& estimates) {
+	if(!executable || estimates.isEmpty())
+		return;
+	QObject::connect(executable, SIGNAL(shardFinished()),
+					 this, SLOT(unitFinished()), Qt::UniqueConnection);
+	QObject::connect(executable, SIGNAL(destroyed(QObject*)),
+					 this, SLOT(executableDestroyed(QObject*)), Qt::UniqueConnection);
+	QList<RunUnit>& units = backlog[executable];
+	for(int i = 0; i < estimates.size(); ++i) {
+		RunUnit unit = { i, estimates.at(i) };
+		units.append(unit);
+	}
+	std::stable_sort(units.begin(), units.end(), longerThan);
+	if(!executables.contains(executable))
+		executables.append(executable);
+	scheduleDispatch();
+}
+
+/*! \brief Drops every unit of the executable that hasn't started yet.
+ *
+ * Units that are already running are unaffected.
+ * \param executable The executable whose backlog is cancelled.
+ * \return The number of units that were dropped.
+ */
+int TestScheduler::cancel(GTestExecutable* executable) {
+	executables.removeAll(executable);
+	int dropped = backlog.take(executable).size();
+	if(dropped > 0 && runningProcesses == 0 && executables.isEmpty())
+		emit idle();
+	return dropped;
+}
+
+/*! \brief Slot called when an executable that submitted units is destroyed.
+ *
+ * Its queued units are dropped and the slots of its running units, which
+ * will never report that they have finished, are freed for other units.
+ * The executable is only used as a key, as it is no longer valid.
+ * \param executable The executable being destroyed.
+ */
+void TestScheduler::executableDestroyed(QObject* executable) {
+	GTestExecutable* key = static_cast<GTestExecutable*>(executable);
+	executables.removeAll(key);
+	int dropped = backlog.take(key).size();
+	int running = launched.take(key);
+	if(dropped == 0 && running == 0)
+		return;
+	runningProcesses = qMax(0, runningProcesses - running);
+	if(runningProcesses == 0 && executables.isEmpty()) {
+		emit idle();
+		return;
+	}
+	scheduleDispatch();
+}
+
+/*! \brief Queues a call to dispatch() if one isn't already pending.
+ */
+void TestScheduler::scheduleDispatch() {
+	if(dispatchPending)
+		return;
+	dispatchPending = true;
+	QTimer::singleShot(0, this, SLOT(dispatch()));
+}
+
+/*! \brief Retrieves the executable whose next unit should be started.
+ *
+ * This is the executable holding the unit with the longest estimate.
+ * Ties are broken in favour of the executable with the longest backlog,
+ * then the one that was submitted first.
+ * \return The executable to start a unit of, or null if nothing is queued.
+ */
+GTestExecutable* TestScheduler::nextExecutable() const {
+	GTestExecutable* next = 0;
+	double nextEstimate = 0;
+	int nextSize = 0;
+	GTestExecutable* executable;
+	foreach(executable, executables) {
+		const QList<RunUnit>& units = backlog[executable];
+		if(units.isEmpty())
+			continue;
+		double estimate = units.first().estimate;
+		if(!next || estimate > nextEstimate
+				 || (estimate == nextEstimate && units.size() > nextSize)) {
+			next = executable;
+			nextEstimate = estimate;
+			nextSize = units.size();
+		}
+	}
+	return next;
+}
+
+/*! \brief Fills every idle process slot with a queued unit.
+ *
+ * Each idle slot takes the longest queued unit.
+ * \see TestScheduler::nextExecutable()
+ */
+void TestScheduler::dispatch() {
+	dispatchPending = false;
+	while(runningProcesses < maxProcesses) {
+		GTestExecutable* executable = nextExecutable();
+		if(!executable)
+			break;
+		QList<RunUnit>& units = backlog[executable];
+		RunUnit unit = units.takeFirst();
+		if(units.isEmpty()) {
+			backlog.remove(executable);
+			executables.removeAll(executable);
+		}
+		++runningProcesses;
+		++launched[executable];
+		executable->launchShard(unit.shardIndex);
+	}
+}
+
+/*! \brief Slot called when a launched unit has finished.
+ *
+ * This frees the unit's process slot and starts the next queued unit.
+ */
+void TestScheduler::unitFinished() {
+	GTestExecutable* executable = static_cast<GTestExecutable*>(sender());
+	QHash<GTestExecutable*, int>::iterator it = launched.find(executable);
+	if(it == launched.end())
+		return;
+	if(--it.value() == 0)
+		launched.erase(it);
+	if(runningProcesses > 0)
+		--runningProcesses;
+	if(runningProcesses == 0 && executables.isEmpty()) {
+		emit idle();
+		return;
+	}
+	dispatch();
+}
@@ -0,0 +1,330 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * TestStore.cpp - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "TestStore.h"
+
+/*! \brief Constructor
+ *
+ */
+TestStore::TestStore()
+: strings(), stringIds(), suiteNames(), suiteRows(), suiteTests(), suiteChecked(),
+  suitePassed(), suiteFailed(), suiteOrder(), suiteIndex(), suiteSeen(), testNames(),
+  testSuites(), testRows(), testCheckStates(), testStatuses(), testIndex(), testSeen(),
+  firstNewSuite(0), firstNewTest(0)
+{}
+
+/*! \brief Destructor
+ *
+ */
+TestStore::~TestStore()
+{}
+
+/*! \brief Retrieves the id of a name, interning it if it is new.
+ */
+int TestStore::intern(const QString& name) {
+	QHash<QString, int>::const_iterator it = stringIds.constFind(name);
+	if(it != stringIds.constEnd())
+		return it.value();
+	int id = strings.size();
+	strings << name;
+	stringIds.insert(name, id);
+	return id;
+}
+
+/*! \brief Starts a new listing.
+ *
+ * Every suite and test added between this call and endListing() is kept,
+ * all others are removed by endListing().
+ */
+void TestStore::beginListing() {
+	suiteSeen.fill(false);
+	testSeen.fill(false);
+	firstNewSuite = suiteNames.size();
+	firstNewTest = testNames.size();
+}
+
+/*! \brief Adds a suite to the current listing.
+ *
+ * New suites are appended after the existing ones.
+ * \param name The name of the suite.
+ * \return The id of the suite, which is the existing id if it was already listed.
+ */
+int TestStore::addSuite(const QString& name) {
+	int nameId = intern(name);
+	int id = suiteIndex.value(nameId, -1);
+	if(id == -1) {
+		id = suiteNames.size();
+		suiteNames << nameId;
+		suiteRows << suiteOrder.size();
+		suiteTests << QVector<int>();
+		suiteChecked << 0;
+		suitePassed << 0;
+		suiteFailed << 0;
+		suiteOrder << id;
+		suiteIndex.insert(nameId, id);
+		suiteSeen.resize(suiteNames.size());
+	}
+	suiteSeen.setBit(id);
+	return id;
+}
+
+/*! \brief Adds a test to a suite of the current listing.
+ *
+ * New tests are appended after the existing tests of the suite and are checked.
+ * \param suite The id of the suite, as returned by addSuite().
+ * \param name The name of the test (without its suite).
+ * \return The id of the test, which is the existing id if it was already listed.
+ */
+int TestStore::addTest(int suite, const QString& name) {
+	QPair<int, int> key(suite, intern(name));
+	int id = testIndex.value(key, -1);
+	if(id == -1) {
+		id = testNames.size();
+		testNames << key.second;
+		testSuites << suite;
+		testRows << suiteTests.at(suite).size();
+		testCheckStates << static_cast<quint8>(Qt::Checked);
+		testStatuses << static_cast<quint8>(NOT_RUN);
+		suiteTests[suite] << id;
+		++suiteChecked[suite];
+		testIndex.insert(key, id);
+		testSeen.resize(testNames.size());
+	}
+	testSeen.setBit(id);
+	return id;
+}
+
+/*! \brief Ends the current listing, removing what it didn't contain.
+ *
+ * The rows of the remaining suites and tests are renumbered, keeping their order.
+ */
+void TestStore::endListing() {
+	QBitArray dirtySuites(suiteNames.size());
+	for(int test = 0; test < testNames.size(); ++test) {
+		if(testRows.at(test) < 0 || testSeen.testBit(test))
+			continue;
+		int suite = testSuites.at(test);
+		if(testCheckStates.at(test) == Qt::Checked)
+			--suiteChecked[suite];
+		countStatus(suite, testStatuses.at(test), -1);
+		testRows[test] = -1;
+		testIndex.remove(qMakePair(suite, testNames.at(test)));
+		dirtySuites.setBit(suite);
+	}
+	bool suitesRemoved = false;
+	for(int suite = 0; suite < suiteNames.size(); ++suite) {
+		if(suiteRows.at(suite) < 0 || suiteSeen.testBit(suite))
+			continue;
+		suiteRows[suite] = -1;
+		suiteIndex.remove(suiteNames.at(suite));
+		suitesRemoved = true;
+	}
+	if(suitesRemoved) {
+		QVector<int> order;
+		int suite;
+		foreach(suite, suiteOrder) {
+			if(suiteRows.at(suite) < 0)
+				continue;
+			suiteRows[suite] = order.size();
+			order << suite;
+		}
+		suiteOrder = order;
+	}
+	for(int suite = 0; suite < suiteNames.size(); ++suite) {
+		if(!dirtySuites.testBit(suite))
+			continue;
+		QVector<int> tests;
+		int test;
+		foreach(test, suiteTests.at(suite)) {
+			if(testRows.at(test) < 0)
+				continue;
+			testRows[test] = tests.size();
+			tests << test;
+		}
+		suiteTests[suite] = tests;
+	}
+}
+
+/*! \brief Retrieves a suite by name.
+ *
+ * \return The suite id, or -1 if there is no such suite.
+ */
+int TestStore::findSuite(const QString& name) const {
+	int nameId = stringIds.value(name, -1);
+	if(nameId == -1)
+		return -1;
+	return suiteIndex.value(nameId, -1);
+}
+
+/*! \brief Retrieves a test of a suite by name.
+ *
+ * \param suite The id of the suite.
+ * \param name The name of the test (without its suite).
+ * \return The test id, or -1 if there is no such test.
+ */
+int TestStore::findTest(int suite, const QString& name) const {
+	int nameId = stringIds.value(name, -1);
+	if(suite < 0 || nameId == -1)
+		return -1;
+	return testIndex.value(qMakePair(suite, nameId), -1);
+}
+
+/*! \brief Retrieves a test by its full name.
+ *
+ * \param fullName The name of the test in the form "suitename.testname".
+ * \return The test id, or -1 if there is no such test.
+ */
+int TestStore::findTest(const QString& fullName) const {
+	int indexOfDot = fullName.indexOf('.');
+	if(indexOfDot == -1)
+		return -1;
+	return findTest(findSuite(fullName.left(indexOfDot)), fullName.mid(indexOfDot + 1));
+}
+
+/*! \brief Adds 'delta' to the passed or failed count of the suite for the status.
+ */
+void TestStore::countStatus(int suite, quint8 status, int delta) {
+	if(status == PASSED)
+		suitePassed[suite] += delta;
+	else if(status == FAILED)
+		suiteFailed[suite] += delta;
+}
+
+/*! \brief Retrieves the number of checked tests in the listing.
+ */
+int TestStore::getCheckedTestCount() const {
+	int count = 0;
+	int suite;
+	foreach(suite, suiteOrder)
+		count += suiteChecked.at(suite);
+	return count;
+}
+
+/*! \brief Retrieves the number of tests in the listing.
+ */
+int TestStore::getTestCount() const {
+	int count = 0;
+	int suite;
+	foreach(suite, suiteOrder)
+		count += suiteTests.at(suite).size();
+	return count;
+}
+
+/*! \brief Retrieves the aggregate check state of every test in the listing.
+ *
+ * \return Qt::Checked if all tests are checked, Qt::Unchecked if none are,
+ * 		   Qt::PartiallyChecked otherwise.
+ */
+Qt::CheckState TestStore::getCheckState() const {
+	int checked = getCheckedTestCount();
+	if(checked == 0)
+		return Qt::Unchecked;
+	return checked == getTestCount() ? Qt::Checked : Qt::PartiallyChecked;
+}
+
+/*! \brief Retrieves the aggregate check state of the tests of a suite.
+ *
+ * \return Qt::Checked if all of its tests are checked, Qt::Unchecked if none
+ * 		   are, Qt::PartiallyChecked otherwise.
+ */
+Qt::CheckState TestStore::getSuiteCheckState(int suite) const {
+	int checked = suiteChecked.value(suite);
+	if(checked == 0)
+		return Qt::Unchecked;
+	return checked == getTestCount(suite) ? Qt::Checked : Qt::PartiallyChecked;
+}
+
+/*! \brief Retrieves the aggregate status of the tests of a suite.
+ *
+ * \return FAILED if any test failed, PASSED if any passed, NOT_RUN otherwise.
+ */
+TestStore::STATUS TestStore::getSuiteStatus(int suite) const {
+	if(suiteFailed.value(suite) > 0)
+		return FAILED;
+	return suitePassed.value(suite) > 0 ? PASSED : NOT_RUN;
+}
+
+/*! \brief Retrieves the aggregate status of every test in the listing.
+ *
+ * \return FAILED if any test failed, PASSED if any passed, NOT_RUN otherwise.
+ */
+TestStore::STATUS TestStore::getStatus() const {
+	bool passed = false;
+	int suite;
+	foreach(suite, suiteOrder) {
+		if(suiteFailed.at(suite) > 0)
+			return FAILED;
+		passed = passed || suitePassed.at(suite) > 0;
+	}
+	return passed ? PASSED : NOT_RUN;
+}
+
+/*! \brief Resets the status of every test to NOT_RUN.
+ */
+void TestStore::resetStatuses() {
+	testStatuses.fill(static_cast<quint8>(NOT_RUN));
+	suitePassed.fill(0);
+	suiteFailed.fill(0);
+}
+
+/*! \brief Checks or unchecks a test.
+ *
+ * \param state Qt::Checked to check the test, any other state unchecks it.
+ */
+void TestStore::setTestCheckState(int test, Qt::CheckState state) {
+	if(testRows.value(test, -1) < 0)
+		return;
+	quint8 newState = static_cast<quint8>(state == Qt::Checked ? Qt::Checked : Qt::Unchecked);
+	if(testCheckStates.at(test) == newState)
+		return;
+	testCheckStates[test] = newState;
+	suiteChecked[testSuites.at(test)] += newState == Qt::Checked ? 1 : -1;
+}
+
+/*! \brief Checks or unchecks every test of a suite.
+ *
+ * \param state Qt::Checked to check the tests, any other state unchecks them.
+ */
+void TestStore::setSuiteCheckState(int suite, Qt::CheckState state) {
+	if(suiteRows.value(suite, -1) < 0)
+		return;
+	quint8 newState = static_cast<quint8>(state == Qt::Checked ? Qt::Checked : Qt::Unchecked);
+	int test;
+	foreach(test, suiteTests.at(suite))
+		testCheckStates[test] = newState;
+	suiteChecked[suite] = newState == Qt::Checked ? suiteTests.at(suite).size() : 0;
+}
+
+/*! \brief Checks or unchecks every test in the listing.
+ *
+ * \param state Qt::Checked to check the tests, any other state unchecks them.
+ */
+void TestStore::setCheckState(Qt::CheckState state) {
+	int suite;
+	foreach(suite, suiteOrder)
+		setSuiteCheckState(suite, state);
+}
+
+/*! \brief Sets the result status of a test.
+ */
+void TestStore::setTestStatus(int test, STATUS status) {
+	if(testRows.value(test, -1) < 0)
+		return;
+	int suite = testSuites.at(test);
+	countStatus(suite, testStatuses.at(test), -1);
+	testStatuses[test] = static_cast<quint8>(status);
+	countStatus(suite, testStatuses.at(test), 1);
+}
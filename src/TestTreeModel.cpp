@@ -15,23 +15,61 @@
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 #include <QApplication>
-#include <QDebug>
+#include <QBrush>
+#include <QColor>
 #include <QMap>
 #include <QMessageBox>
 #include <QModelIndexList>
 #include <QSharedPointer>
-#include <QStack>
 #include <QStatusBar>
+#include <QThread>
+#include <QTimer>
 #include "TestTreeModel.h"
 #include "TreeItem.h"
 #include "GTestExecutable.h"
+#include "ListingCache.h"
+#include "LogView.h"
+#include "TestEngine.h"
+#include "TestHistory.h"
+#include "TestScheduler.h"
+
+#include <algorithm>
+
+/*! \brief The number of test items created each time a suite fetches more of its tests.
+ */
+static const int FETCH_CHUNK = 500;
+
+/*! \brief The minimum time, in milliseconds, between two updates of the tests' progress.
+ */
+static const int PROGRESS_INTERVAL = 30;
+
+/*! \brief The time, in milliseconds, that the durations of a finished run are kept before they are saved.
+ */
+static const int HISTORY_SAVE_DELAY = 60 * 1000;
 
 /*! \brief Constructor
  *
  */
-TestTreeModel::TestTreeModel(QObject* parent, QPlainTextEdit *result)
-: TreeModel(parent)
+TestTreeModel::TestTreeModel(QObject* parent, LogView *result)
+: TreeModel(parent), m_ShardCount(0), m_JsonResults(false), m_KeptRuns(-1), m_EndedTests(), m_BegunExecutable(0), m_BegunTest(-1)
 {
+    m_Scheduler = new TestScheduler(this);
+    m_ProgressTimer = new QTimer(this);
+    m_ProgressTimer->setSingleShot(true);
+    m_ProgressTimer->setInterval(PROGRESS_INTERVAL);
+    QObject::connect(m_ProgressTimer, SIGNAL(timeout()), this, SLOT(showProgress()));
+    m_History = new TestHistory();
+    m_HistoryTimer = new QTimer(this);
+    m_HistoryTimer->setSingleShot(true);
+    m_HistoryTimer->setInterval(HISTORY_SAVE_DELAY);
+    QObject::connect(m_HistoryTimer, SIGNAL(timeout()), this, SLOT(saveHistory()));
+    m_ListingCache = new ListingCache();
+    m_EngineThread = new QThread(this);
+    m_Engine = new TestEngine();
+    m_Engine->moveToThread(m_EngineThread);
+    QObject::connect(m_EngineThread, SIGNAL(finished()), m_Engine, SLOT(deleteLater()));
+    m_EngineThread->start();
+
 	QList<QMap<int, QVariant> > data;
 	QMap<int, QVariant> datum;
 	datum.insert(Qt::DisplayRole, "Test Name");
@@ -44,8 +82,17 @@ TestTreeModel::TestTreeModel(QObject* parent, QPlainTextEdit *result)
 
 /*! \brief Destructor
  *
+ * Saves the durations of the runs that haven't been saved yet.
  */
-TestTreeModel::~TestTreeModel() {}
+TestTreeModel::~TestTreeModel() {
+    //The executables still hand their jobs to the engine as they are deleted.
+    testExeHash.clear();
+    m_EngineThread->quit();
+    m_EngineThread->wait();
+    saveHistory();
+    delete m_History;
+    delete m_ListingCache;
+}
 
 /*! \brief This function adds a data source for this model.
  *
@@ -58,12 +105,23 @@ TestTreeModel::ERROR TestTreeModel::addDataSource(const QString filepath, const
 	QSharedPointer<GTestExecutable> newTest(new GTestExecutable(this));
 	newTest->setExecutablePath(filepath);
     newTest->setResultPath(outputDir);
+    if(m_ShardCount > 0)
+        newTest->setShardCount(m_ShardCount);
+    newTest->setJsonResults(m_JsonResults);
+    if(m_KeptRuns >= 0)
+        newTest->setKeptRuns(m_KeptRuns);
+    newTest->setScheduler(m_Scheduler);
+    newTest->setHistory(m_History);
+    newTest->setListingCache(m_ListingCache);
+    newTest->setEngine(m_Engine);
 	switch(newTest->getState()) {
 	case GTestExecutable::VALID:
         QObject::connect(newTest.data(), SIGNAL(listingReady(GTestExecutable*)), this, SLOT(updateListing(GTestExecutable*)));
-        QObject::connect(newTest.data(), SIGNAL(BeginTest(GTest*)), this, SLOT(BeginTest(GTest*)));
-        QObject::connect(newTest.data(), SIGNAL(EndTest(GTest*, bool)), this, SLOT(EndTest(GTest*, bool)));
-        QObject::connect(this, SIGNAL(aboutToRunTests()), newTest.data(), SLOT(resetRunState()));
+        QObject::connect(newTest.data(), SIGNAL(BeginTest(GTestExecutable*, int)), this, SLOT(BeginTest(GTestExecutable*, int)));
+        QObject::connect(newTest.data(), SIGNAL(EndTest(GTestExecutable*, int, bool)), this, SLOT(EndTest(GTestExecutable*, int, bool)));
+        QObject::connect(newTest.data(), SIGNAL(testsFinished(GTestExecutable*)), this, SLOT(populateTestResult(GTestExecutable*)));
+        QObject::connect(newTest.data(), SIGNAL(jobFinished(GTestExecutable*, int)), this, SLOT(runJobEnded(GTestExecutable*, int)));
+        QObject::connect(newTest.data(), SIGNAL(jobCancelled(GTestExecutable*, int)), this, SLOT(runJobEnded(GTestExecutable*, int)));
 		//We insert it so that it doesn't auto-delete from the shared ptr.
 		//Will probably be useful later on when we want to save settings.
 		testExeHash.insert(newTest->objectName(), newTest);
@@ -80,9 +138,27 @@ TestTreeModel::ERROR TestTreeModel::addDataSource(const QString filepath, const
 }
 
 
+/*! \brief Sets the maximum number of test processes running at once across all executables.
+ */
+void TestTreeModel::setMaxProcesses(int maxProcesses){
+    m_Scheduler->setMaxProcesses(maxProcesses);
+}
+
+/*! \brief Sets whether executables without a build-id are identified by a hash of their contents.
+ * \see ListingCache::setHashContents()
+ */
+void TestTreeModel::setHashListings(bool hashListings){
+    m_ListingCache->setHashContents(hashListings);
+}
+
 /*! \brief Kill all QProcess.
+ *
+ * Queued jobs are cancelled. The executables still report their aborted
+ * runs afterwards, which runJobEnded() ignores once no run job is pending.
  */
 void TestTreeModel::AbortCurrentTests(){
+    // Forget the runs first, so that cancelling them doesn't complete the run again.
+    m_RunJobs.clear();
     // Send kill signal to the QProcess.
     QHash<QString, QSharedPointer<GTestExecutable> >::iterator it = testExeHash.begin();
     while(it != testExeHash.end()) {
@@ -90,38 +166,27 @@ void TestTreeModel::AbortCurrentTests(){
         ++it;
     }
 
-    // Cleanup
-    while(m_processCount.deref())
-        ;
     emit allTestsCompleted();
 }
 
-/*! \brief Creates a tree item and sets up some slot/signals.
+/*! \brief Creates the tree item of an executable.
  *
- * This function is a help to the updateListing method which enables
- * simplified creation of new tree items. It is templated as I didn't
- * feel like writing three copies of the same code (thus making the
- * function useless). It simply sets up some common states among tree
- * items and some signal/slots between the tree item and its corresponding
- * test item.
+ * This function is a help to the updateListing method. The executable's
+ * item is the only one holding data of its own, the items below it are
+ * looked up in the executable's TestStore.
  */
-template <class T, class U>
-TreeItem* TestTreeModel::createNewTreeItem(T parent, U* test) {
+TreeItem* TestTreeModel::createNewTreeItem(GTestExecutable* gtest) {
 	QVariant var;
 	QList<QMap<int, QVariant> > data;
 	QMap<int, QVariant> datum;
-	var.setValue<QString>(test->objectName());
+	var.setValue<QString>(gtest->objectName());
 	datum.insert(Qt::DisplayRole, var);
-	var.setValue<GTest*>(test);
+	var.setValue<GTestExecutable*>(gtest);
 	datum.insert(Qt::UserRole, var);
-    var.setValue(static_cast<int>(Qt::Checked));
-	datum.insert(Qt::CheckStateRole, var);
 	data.append(datum);
 
-	TreeItem* newTreeItem(new TreeItem(data, parent));
-	itemTestHash.insert(test, newTreeItem);
-	QObject::connect(test, SIGNAL(testResultsReady()),
-					 this, SLOT(populateTestResult()));
+	TreeItem* newTreeItem(new TreeItem(data));
+	itemExeHash.insert(gtest, newTreeItem);
 	return newTreeItem;
 }
 
@@ -129,9 +194,17 @@ TreeItem* TestTreeModel::createNewTreeItem(T parent, U* test) {
  *
  * This function takes the 'gtest' and retrieves its listing. It then
  * takes the listing and populates the main test tree with the tests
- * it provides.
- * \todo TODO::Update a listing that already exists.
- * \todo TODO::Refactor this method. It's a bit too long.
+ * it provides. Items of suites and tests that are no longer listed are
+ * removed and items for those that are new are appended, which keeps
+ * the rows of the tree the same as the rows of the store.
+ * The new items are built off-model and published with a single insertion
+ * per parent, and removed items are retracted one contiguous range at a
+ * time, so the views only relayout a handful of times however large the
+ * listing is. The items of a suite's tests are only created once the view
+ * fetches them, so new tests are only added to suites whose items have
+ * all been fetched already.
+ * \see TestStore::endListing()
+ * \see TestTreeModel::fetchMore()
  */
 void TestTreeModel::updateListing(GTestExecutable* gtest) {
 	const int exitCode = gtest->getExitCode();
@@ -143,170 +216,271 @@ void TestTreeModel::updateListing(GTestExecutable* gtest) {
 		return;
 	}
 
-	TreeItem* suiteTreeItem;
-	TreeItem* treeItem;
-	TreeItem* exeTreeItem = rootItem.findChild(gtest->objectName(), Qt::DisplayRole);
-
-	if(!exeTreeItem) {
-		//If we haven't added the test yet, make one now.
-		exeTreeItem = createNewTreeItem<TreeItem*,GTestExecutable>(&rootItem, gtest);
-		this->insertItem(exeTreeItem, rootItem.childCount(), &rootItem);
+	const TestStore& store = gtest->getStore();
+	TreeItem* exeTreeItem = itemExeHash.value(gtest);
+	bool newExecutable = (exeTreeItem == 0);
+	if(newExecutable) //If we haven't added the test yet, make one now.
+		exeTreeItem = createNewTreeItem(gtest);
+	else
+		removeUnlisted(exeTreeItem, store);
 
-		QObject::connect(this, SIGNAL(runningTests()),
-						 gtest, SLOT(runTest()));
+	//New suites and tests have the highest ids and were appended to the store in id order.
+	QList<TreeItem* > newSuiteItems;
+	for(int suite = newExecutable ? 0 : store.getFirstNewSuite(); suite < store.getSuiteIdCount(); ++suite) {
+		if(store.getSuiteRow(suite) >= 0)
+			newSuiteItems << new TreeItem(suite);
+	}
+	//The tests of new suites are left for fetchMore().
+	QHash<TreeItem*, QList<TreeItem* > > newTestItems;
+	int firstNewRow = exeTreeItem->childCount();
+	for(int test = newExecutable ? 0 : store.getFirstNewTest(); test < store.getTestIdCount(); ++test) {
+		if(store.getTestRow(test) < 0)
+			continue;
+		int suiteRow = store.getSuiteRow(store.getTestSuite(test));
+		if(suiteRow < firstNewRow)
+			newTestItems[exeTreeItem->child(suiteRow)] << new TreeItem(test);
+	}
 
+	if(newExecutable) {
+		exeTreeItem->insertChildren(0, newSuiteItems);
+		this->insertItem(exeTreeItem, rootItem.childCount(), &rootItem);
 	}
-	//Get which of the tests are new. This should be all of them the first
-	//time through for this test.
-	QSet<QString> newTests = gtest->getListing() - gtest->getOldListing();
-
-	//! \todo Remove old tests that are no longer present.
-
-	//Iterate through all the suites.
-	QList<GTestSuite*> suiteList = gtest->findChildren<GTestSuite*>();
-	QList<GTestSuite*>::iterator suiteIter = suiteList.begin();
-	while(suiteIter != suiteList.end()) {
-		if(!newTests.contains((*suiteIter)->objectName())) {
-			suiteIter++;
-			continue; //already have this added
+	else {
+		this->insertItems(newSuiteItems, firstNewRow, exeTreeItem);
+		QHash<TreeItem*, QList<TreeItem* > >::iterator it = newTestItems.begin();
+		for(; it != newTestItems.end(); ++it) {
+			TreeItem* suiteTreeItem = it.key();
+			//The items are a prefix of the suite's tests, only extend it if it was complete.
+			if(suiteTreeItem->childCount() + it.value().size() == store.getTestCount(suiteTreeItem->getId()))
+				this->insertItems(it.value(), suiteTreeItem->childCount(), suiteTreeItem);
+			else
+				qDeleteAll(it.value());
 		}
+		//the aggregate check states of the executable and of suites with new tests may have changed
+		emitChanged(exeTreeItem);
+		int count = exeTreeItem->childCount();
+		if(count > 0)
+			emit dataChanged(indexOf(exeTreeItem->child(0)), indexOf(exeTreeItem->child(count - 1)));
+	}
+}
 
-		//Create a new GTestSuite tree item.
-		suiteTreeItem = createNewTreeItem<TreeItem*,GTestSuite>(exeTreeItem, *suiteIter);
-		this->insertItem(suiteTreeItem, exeTreeItem->childCount(), exeTreeItem);
-
-		//Iterate through all the tests of this suite.
-		QList<GTest*> testList = (*suiteIter)->findChildren<GTest*>();
-		QList<GTest*>::iterator testIter = testList.begin();
-		while(testIter != testList.end()) {
-			if(!newTests.contains((*suiteIter)->objectName().append('.').append((*testIter)->objectName()))) {
-				testIter++;
-				continue; //already have this added
-			}
-
-			//Create a new GTest tree item.
-			treeItem = createNewTreeItem<TreeItem*, GTest>(suiteTreeItem, *testIter);
-			this->insertItem(treeItem, suiteTreeItem->childCount(), suiteTreeItem);
-			++testIter;
+/*! \brief Removes the items of the suites and tests that are no longer listed by the store.
+ *
+ * Each contiguous range of unlisted siblings is removed at once.
+ */
+void TestTreeModel::removeUnlisted(TreeItem* exeTreeItem, const TestStore& store) {
+	for(int row = exeTreeItem->childCount() - 1; row >= 0; --row) {
+		TreeItem* suiteTreeItem = exeTreeItem->child(row);
+		if(store.getSuiteRow(suiteTreeItem->getId()) < 0) {
+			int first = row;
+			while(first > 0 && store.getSuiteRow(exeTreeItem->child(first - 1)->getId()) < 0)
+				--first;
+			this->removeItems(first, row - first + 1, exeTreeItem);
+			row = first;
+			continue;
 		}
-		++suiteIter;
-	}
-	emit layoutChanged();
-}
-
-void TestTreeModel::BeginTest(GTest* test){
-    TreeItem* treeItem = itemTestHash.value(test);
-    if(treeItem == 0)
-        return;
-    QModelIndex index = createIndex(treeItem->row(), treeItem->column(), treeItem);
-    selectionModel->setCurrentIndex(index, QItemSelectionModel::ClearAndSelect);
-    m_MainWindow->statusBar()->showMessage("Running: " + test->objectName());
-}
-
-void TestTreeModel::EndTest(GTest * test, bool success){
-    TreeItem* treeItem = itemTestHash.value(test);
-    if(treeItem == 0)
-        return;
-    QModelIndex index = createIndex(treeItem->row(), treeItem->column(), treeItem);
-    if(success)
-        setData(index, QVariant(QBrush(QColor(0xAB,0xFF,0xBB,0xFF))), Qt::BackgroundRole);
-    else
-        setData(index, QVariant(QBrush(QColor(0xFF,0x88,0x88,0xFF))), Qt::BackgroundRole);
-}
-
-/*! \brief Populates a test result into the test tree.
- *
- * This function takes a QObject* which should be a TestTreeWidgetItem.
- * If it is called with anything else, the function does nothing. It takes
- * the item and retrieves its corresponding GTest. The GTest should already
- * have its updated result attached to it, thus, it retrieves the result
- * and sets the item to the appropriate pass / fail state.
- * \param item This should be a TestTreeWidgetItem which needs its test result updated.
- */
-void TestTreeModel::populateTestResult() {
-	GTest* test = static_cast<GTest*>(sender());
-	if(test == 0)
-		return; //! \todo exception management stuff here
-	TreeItem* treeItem = itemTestHash.value(test);
-	if(treeItem == 0)
-		return; //! \todo exception management stuff here
-
-	QVariant var = treeItem->data(0, Qt::UserRole);
-	GTest* testItem = var.value<GTest*>();
-	if(testItem == 0) {
-		testItem = var.value<GTestSuite*>();
-		if(testItem == 0) {
-			testItem = var.value<GTestExecutable*>();
-			if(testItem == 0)
-				return; //! \todo exception management stuff here
+		for(int testRow = suiteTreeItem->childCount() - 1; testRow >= 0; --testRow) {
+			if(store.getTestRow(suiteTreeItem->child(testRow)->getId()) >= 0)
+				continue;
+			int first = testRow;
+			while(first > 0 && store.getTestRow(suiteTreeItem->child(first - 1)->getId()) < 0)
+				--first;
+			this->removeItems(first, testRow - first + 1, suiteTreeItem);
+			testRow = first;
 		}
 	}
+}
 
-	const GTestResults* testResults = testItem->getTestResults();
-	if(testResults == 0)
-		return;
+/*! \brief Records that a test has started running.
+ *
+ * The test is shown by showProgress(), unless another one begins first.
+ */
+void TestTreeModel::BeginTest(GTestExecutable* gtest, int test){
+    m_BegunExecutable = gtest;
+    m_BegunTest = test;
+    if(!m_ProgressTimer->isActive())
+        m_ProgressTimer->start();
+}
 
-	QModelIndex index = createIndex(treeItem->row(), treeItem->column(), treeItem);
-	if(testResults->getFailureCount() == 0)
-		setData(index, QVariant(QBrush(QColor(0xAB,0xFF,0xBB,0xFF))), Qt::BackgroundRole);
-	else
-		setData(index, QVariant(QBrush(QColor(0xFF,0x88,0x88,0xFF))), Qt::BackgroundRole);
+/*! \brief Records that a test has finished running.
+ *
+ * The status has already been recorded in the store by the executable, the
+ * test's item is repainted by showProgress().
+ */
+void TestTreeModel::EndTest(GTestExecutable* gtest, int test, bool success){
+    Q_UNUSED(success);
+    m_EndedTests[gtest] << test;
+    if(!m_ProgressTimer->isActive())
+        m_ProgressTimer->start();
+}
 
-    if(m_processCount.deref()){
-        emit allTestsCompleted();
+/*! \brief Shows the progress of the running tests since it was last shown.
+ *
+ * Fast tests begin and end far more often than the view can be repainted,
+ * so BeginTest() and EndTest() only record the events and this is called
+ * at most every PROGRESS_INTERVAL milliseconds. The items of the tests that
+ * have ended are repainted with one dataChanged() per contiguous range of
+ * rows, followed by their suites (whose aggregate status may have changed)
+ * and executables. Only the test that began last is selected and shown in
+ * the status bar. A test whose item hasn't been fetched yet only repaints
+ * its suite. If the current test has ended, its results are shown again
+ * as they are complete now.
+ */
+void TestTreeModel::showProgress(){
+    m_ProgressTimer->stop();
+    TreeItem* currentItem = static_cast<TreeItem*>(selectionModel->currentIndex().internalPointer());
+    bool currentEnded = currentItem && levelOf(currentItem) == TEST
+        && m_EndedTests.value(executableOf(currentItem)).contains(currentItem->getId());
+    QHash<GTestExecutable*, QSet<int> >::iterator it = m_EndedTests.begin();
+    for(; it != m_EndedTests.end(); ++it) {
+        TreeItem* exeTreeItem = itemExeHash.value(it.key());
+        if(!exeTreeItem)
+            continue;
+        const TestStore& store = it.key()->getStore();
+        QHash<TreeItem*, QList<int> > testRows;
+        QSet<int> suiteRows;
+        int test;
+        foreach(test, it.value()) {
+            int suiteRow = store.getSuiteRow(store.getTestSuite(test));
+            TreeItem* suiteTreeItem = exeTreeItem->child(suiteRow);
+            if(!suiteTreeItem)
+                continue;
+            suiteRows << suiteRow;
+            if(suiteTreeItem->child(store.getTestRow(test)))
+                testRows[suiteTreeItem] << store.getTestRow(test);
+        }
+        QHash<TreeItem*, QList<int> >::iterator rows = testRows.begin();
+        for(; rows != testRows.end(); ++rows)
+            emitRowsChanged(rows.key(), rows.value());
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        emitRowsChanged(exeTreeItem, QList<int>(suiteRows.begin(), suiteRows.end()));
+#else
+        emitRowsChanged(exeTreeItem, suiteRows.toList());
+#endif
+        emitChanged(exeTreeItem);
+    }
+    m_EndedTests.clear();
+    if(currentEnded && !m_BegunExecutable)
         printResult(selectionModel->currentIndex(), QModelIndex());
+
+    if(m_BegunExecutable) {
+        m_MainWindow->statusBar()->showMessage("Running: " + m_BegunExecutable->getStore().getTestName(m_BegunTest));
+        TreeItem* treeItem = itemOf(m_BegunExecutable, m_BegunTest);
+        if(treeItem)
+            selectionModel->setCurrentIndex(indexOf(treeItem), QItemSelectionModel::ClearAndSelect);
+        m_BegunExecutable = 0;
     }
 }
 
-/*! \brief Clear background of the Test Tree before running it.
+/*! \brief Saves the durations recorded since the history was last saved.
  *
+ * The history file is rewritten as a whole, so it is saved at most once
+ * every HISTORY_SAVE_DELAY milliseconds, and on destruction, rather than
+ * after every run.
  */
-void TestTreeModel::ClearTestTreeBackground(TreeItem * treeItem){
-    QModelIndex index = createIndex(treeItem->row(), treeItem->column(), treeItem);
-    setData(index, QVariant(QBrush()), Qt::BackgroundRole); // this will restore the default value
+void TestTreeModel::saveHistory() {
+	if(m_History->isModified())
+		m_History->save();
+}
 
-    TreeItem * testitem;
-    foreach(testitem, treeItem->children()){
-        ClearTestTreeBackground(testitem);
-    }
+/*! \brief Notifies the views that the data of some children of an item has changed.
+ *
+ * A single signal is emitted for each contiguous range of rows.
+ * \param parent The item whose children have changed.
+ * \param rows The rows of the children that have changed, in any order.
+ */
+void TestTreeModel::emitRowsChanged(TreeItem* parent, QList<int> rows) {
+	std::sort(rows.begin(), rows.end());
+	int i = 0;
+	while(i < rows.size()) {
+		int first = rows.at(i);
+		int last = first;
+		for(++i; i < rows.size() && rows.at(i) <= last + 1; ++i)
+			last = rows.at(i);
+		emit dataChanged(createIndex(first, 0, parent->child(first)), createIndex(last, 0, parent->child(last)));
+	}
 }
 
+/*! \brief Populates the test results of a run into the test tree.
+ *
+ * This function is called when 'gtest' has finished a run. The executable
+ * has already updated the statuses of its tests from the results, so the
+ * executable's items only need to be repainted. The running time of the
+ * longest shard of a sharded run is shown in the status bar next to its
+ * estimate. If some of the run's output could not be spilled to disk, this
+ * is reported there instead.
+ * \param gtest The executable whose run has finished.
+ */
+void TestTreeModel::populateTestResult(GTestExecutable* gtest) {
+	showProgress();
+	//The history is saved once for the runs finishing within HISTORY_SAVE_DELAY of each other.
+	if(m_History->isModified() && !m_HistoryTimer->isActive())
+		m_HistoryTimer->start();
+	emitChanged(itemExeHash.value(gtest), TO_CHILDREN);
+	if(gtest->getRunShardCount() > 1 && gtest->getActualMakespan() > 0)
+		m_MainWindow->statusBar()->showMessage(tr("%1 ran in %2 %3 shards: predicted makespan %4 s, actual makespan %5 s")
+											   .arg(gtest->objectName()).arg(gtest->getRunShardCount())
+											   .arg(gtest->isBalancedRun() ? tr("duration balanced") : tr("round-robin"))
+											   .arg(gtest->getPredictedMakespan(), 0, 'f', 1)
+											   .arg(gtest->getActualMakespan(), 0, 'f', 1));
+	OutputCapturePointer capture;
+	foreach(capture, gtest->getStandardOutput() + gtest->getStandardError()) {
+		QString error = capture->getSpillError();
+		if(!error.isEmpty()) {
+			m_MainWindow->statusBar()->showMessage(tr("Some output of %1 was lost, as it could not be written to disk: %2")
+												   .arg(gtest->objectName()).arg(error));
+			break;
+		}
+	}
+}
+
+/*! \brief Slot called when a job queued on an executable has finished or been cancelled.
+ *
+ * Once the last run job started by runTests() has ended, the run as a
+ * whole is complete.
+ * \param gtest The executable the job was queued on.
+ * \param job The id of the job.
+ */
+void TestTreeModel::runJobEnded(GTestExecutable* gtest, int job) {
+	Q_UNUSED(gtest);
+	if(m_RunJobs.remove(job) && m_RunJobs.isEmpty()) {
+		emit allTestsCompleted();
+		printResult(selectionModel->currentIndex(), QModelIndex());
+	}
+}
+
+/*! \brief Clear background of the Test Tree before running it.
+ *
+ */
+void TestTreeModel::ClearTestTreeBackground(){
+    QHash<GTestExecutable*, TreeItem* >::iterator it = itemExeHash.begin();
+    for(; it != itemExeHash.end(); ++it)
+        it.key()->getStore().resetStatuses();
+    emitChildrenChanged(&rootItem);
+}
 
 /*! \brief Runs all tests that are checked.
  *
  * This is the only way tests results are populated into the model.
  * This is the method the model uses to notify the GTestExecutables to run
  * their corresponding executable on the file system and to populate its results
- * into the data model.
+ * into the data model. Each executable runs the tests checked in its store.
  */
 void TestTreeModel::runTests() {
 	emit aboutToRunTests();
 
-    ClearTestTreeBackground(&rootItem);
-
-	QStack<TreeItem* > stack;
-	QList<TreeItem* > children;
-	TreeItem* item;
-	stack.push(&rootItem);
+    ClearTestTreeBackground();
 
-	while(!stack.isEmpty()) {
-		item = stack.pop();
-		GTest* test = item->data(0, Qt::UserRole).value<GTest*>();
-        if(test && (item->data(0, Qt::CheckStateRole).value<int>() == Qt::Checked)){
-            m_processCount.ref();
-			test->run();
-            }
-		else {
-			children = item->children();
-			QList<TreeItem* >::iterator it = children.begin();
-			while(it != children.end()) {
-				stack.push(*it);
-				++it;
-			}
-		}
+	QHash<GTestExecutable*, TreeItem* >::iterator it = itemExeHash.begin();
+	for(; it != itemExeHash.end(); ++it) {
+		int job = it.key()->runTest();
+		if(job)
+			m_RunJobs.insert(job, it.key());
 	}
 
 	emit runningTests();
+	if(m_RunJobs.isEmpty()) //nothing to wait for, but let the caller finish starting the run first
+		QTimer::singleShot(0, this, SIGNAL(allTestsCompleted()));
 }
 
 /*! \brief Updates all the listings for every GTestExecutable.
@@ -324,8 +498,9 @@ void TestTreeModel::updateAllListings() {
 
 /*! \brief Retrieves the data specified by the given index and role.
  *
- * This function only gives metadata specific data, specified by the
- * Qt::MetaDataRole. Other data is requested from the parent class.
+ * The data of an executable's item is held by the item itself, apart from
+ * its check state and background which are aggregated from its store. The
+ * data of suite and test items is looked up in the store by the item's id.
  * \see TreeModel::data()
  * \param index A model index to this tree model.
  * \param role The role to retrieve data from.
@@ -333,11 +508,185 @@ void TestTreeModel::updateAllListings() {
  */
 QVariant TestTreeModel::data(const QModelIndex& index, int role) const {
 	TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
-	if(item)
+	if(!item)
+		return QVariant();
+	GTestExecutable* gtest = executableOf(item);
+	if(!gtest)
+		return item->data(0, role);
+	const TestStore& store = gtest->getStore();
+	switch(levelOf(item)) {
+	case EXECUTABLE:
+		if(role == Qt::CheckStateRole)
+			return static_cast<int>(store.getCheckState());
+		if(role == Qt::BackgroundRole)
+			return statusBrush(store.getStatus());
 		return item->data(0, role);
+	case SUITE: {
+		GTestSuite suite(&store, item->getId());
+		if(role == Qt::DisplayRole)
+			return suite.getName();
+		if(role == Qt::CheckStateRole)
+			return static_cast<int>(suite.getCheckState());
+		if(role == Qt::BackgroundRole)
+			return statusBrush(suite.getStatus());
+		return QVariant();
+	}
+	case TEST: {
+		GTest test(&store, item->getId());
+		if(role == Qt::DisplayRole)
+			return test.getName();
+		if(role == Qt::CheckStateRole)
+			return static_cast<int>(test.getCheckState());
+		if(role == Qt::BackgroundRole)
+			return statusBrush(test.getStatus());
+		return QVariant();
+	}
+	default:
+		return item->data(0, role);
+	}
+}
+
+/*! \brief Retrieves the background brush that shows a test status.
+ *
+ * \return A green brush for passed, a red brush for failed and an
+ * 		   empty variant (the default background) otherwise.
+ */
+QVariant TestTreeModel::statusBrush(TestStore::STATUS status) {
+	if(status == TestStore::PASSED)
+		return QVariant(QBrush(QColor(0xAB,0xFF,0xBB,0xFF)));
+	if(status == TestStore::FAILED)
+		return QVariant(QBrush(QColor(0xFF,0x88,0x88,0xFF)));
 	return QVariant();
 }
 
+/*! \brief Retrieves the depth of the item in the unit test tree hierarchy.
+ */
+TestTreeModel::LEVEL TestTreeModel::levelOf(TreeItem* item) const {
+	int level = ROOT;
+	for(; item && item != &rootItem; item = item->parent())
+		++level;
+	return static_cast<LEVEL>(level);
+}
+
+/*! \brief Retrieves the executable the item belongs to.
+ *
+ * \return The executable, or null for the root item.
+ */
+GTestExecutable* TestTreeModel::executableOf(TreeItem* item) const {
+	while(item && item->parent() && item->parent() != &rootItem)
+		item = item->parent();
+	if(!item || item == &rootItem)
+		return 0;
+	return item->data(0, Qt::UserRole).value<GTestExecutable*>();
+}
+
+/*! \brief Retrieves the item of a suite.
+ *
+ * Since the rows of the items are the same as the rows of the store,
+ * this is a constant time lookup.
+ * \param gtest The executable of the suite.
+ * \param suite The id of the suite in the executable's store.
+ * \return The item, or null if there is none.
+ */
+TreeItem* TestTreeModel::suiteItemOf(GTestExecutable* gtest, int suite) const {
+	TreeItem* exeTreeItem = itemExeHash.value(gtest);
+	if(!exeTreeItem)
+		return 0;
+	return exeTreeItem->child(gtest->getStore().getSuiteRow(suite));
+}
+
+/*! \brief Retrieves the item of a test.
+ *
+ * Since the rows of the items are the same as the rows of the store,
+ * this is a constant time lookup.
+ * \param gtest The executable of the test.
+ * \param test The id of the test in the executable's store.
+ * \return The item, or null if there is none or it hasn't been fetched yet.
+ */
+TreeItem* TestTreeModel::itemOf(GTestExecutable* gtest, int test) const {
+	TreeItem* suiteTreeItem = suiteItemOf(gtest, gtest->getStore().getTestSuite(test));
+	if(!suiteTreeItem)
+		return 0;
+	return suiteTreeItem->child(gtest->getStore().getTestRow(test));
+}
+
+/*! \brief Whether the item given by 'parent' has any children.
+ *
+ * A suite has children as soon as it has tests, whether or not their items
+ * have been fetched, so that the view shows it as expandable.
+ */
+bool TestTreeModel::hasChildren(const QModelIndex& parent) const {
+	TreeItem* item = static_cast<TreeItem*>(parent.internalPointer());
+	if(parent.isValid() && item && levelOf(item) == SUITE)
+		return executableOf(item)->getStore().getTestCount(item->getId()) > 0;
+	return TreeModel::hasChildren(parent);
+}
+
+/*! \brief Whether the item given by 'parent' has tests whose items haven't been fetched.
+ *
+ * \see TestTreeModel::fetchMore()
+ */
+bool TestTreeModel::canFetchMore(const QModelIndex& parent) const {
+	TreeItem* item = static_cast<TreeItem*>(parent.internalPointer());
+	if(!parent.isValid() || !item || levelOf(item) != SUITE)
+		return false;
+	return item->childCount() < executableOf(item)->getStore().getTestCount(item->getId());
+}
+
+/*! \brief Creates the items of the next FETCH_CHUNK tests of the suite given by 'parent'.
+ *
+ * The items of a suite's tests are created as the view needs them (when the
+ * suite is expanded or scrolled through), so that suites with a very large
+ * number of tests don't materialise all of them. The fetched items are
+ * always a prefix of the suite's tests in the store. Check states and
+ * statuses of the suite and executable are aggregated by the store, so they
+ * take the tests that haven't been fetched into account.
+ */
+void TestTreeModel::fetchMore(const QModelIndex& parent) {
+	if(!canFetchMore(parent))
+		return;
+	TreeItem* suiteTreeItem = static_cast<TreeItem*>(parent.internalPointer());
+	const TestStore& store = executableOf(suiteTreeItem)->getStore();
+	int suite = suiteTreeItem->getId();
+	int first = suiteTreeItem->childCount();
+	int last = qMin(first + FETCH_CHUNK, store.getTestCount(suite));
+	QList<TreeItem* > items;
+	items.reserve(last - first);
+	for(int row = first; row < last; ++row)
+		items << new TreeItem(store.getTest(suite, row));
+	this->insertItems(items, first, suiteTreeItem);
+}
+
+/*! \brief Notifies the views that the data of an item has changed.
+ *
+ * \param item The item whose data has changed.
+ * \param recursionDirection Whether the item's ancestors (TO_PARENT) and/or
+ * 		  descendants (TO_CHILDREN) have changed as well.
+ */
+void TestTreeModel::emitChanged(TreeItem* item, int recursionDirection) {
+	if(!item || item == &rootItem)
+		return;
+	QModelIndex index(createIndex(item->row(), 0, item));
+	emit dataChanged(index, index);
+	if(recursionDirection & TO_CHILDREN)
+		emitChildrenChanged(item);
+	if(recursionDirection & TO_PARENT)
+		emitChanged(item->parent(), TO_PARENT);
+}
+
+/*! \brief Notifies the views that the data of every descendant of an item has changed.
+ *
+ * A single signal is emitted for each item's children.
+ */
+void TestTreeModel::emitChildrenChanged(TreeItem* item) {
+	int count = item->childCount();
+	if(count == 0)
+		return;
+	emit dataChanged(createIndex(0, 0, item->child(0)), createIndex(count - 1, 0, item->child(count - 1)));
+	for(int i = 0; i < count; ++i)
+		emitChildrenChanged(item->child(i));
+}
+
 /*! \brief Sets the data of the given index and role to the variant var.
  *
  * This function only handles the Qt::CheckStateRole role to manage appropriate
@@ -364,112 +713,130 @@ bool TestTreeModel::setData(const QModelIndex& index, const QVariant& var, int r
 
 /*! \brief Sets the checkstate on the given item.
  *
- * This function is recursive. The recursion is only allowed to propagate
- * away from the original item that has been checked. This function maintains
- * the consistency of the check states of items contained in the model. The rules
- * are described as follows:
+ * The check states are held by the executable's store, which only records
+ * whether each test is checked. The state of a suite or executable is
+ * derived from its tests, so the rules below hold by construction:
  * \li An item that is a leaf (i.e. has no children) cannot be partially checked.
- * \li An item must be set to partially checked if it contains both checked and unchecked
- * 	   or partially checked child items.
- * \li If a partially checked item is changed to checked, all its children will be checked.
- * \li If a checked item is set to unchecked, all its children will be unchecked.
+ * \li An item is partially checked if it contains both checked and unchecked tests.
+ * \li If an item is checked or unchecked, so are all its tests.
+ * A partially checked state, as set by clicking a tristate item, checks the
+ * item's tests unless they were all checked, in which case they are unchecked.
  * \return true of the checking was successful, false otherwise.
  */
-bool TestTreeModel::setCheckState(TreeItem* item, Qt::CheckState newState, int recursionDirection) {
-	if(!item)
+bool TestTreeModel::setCheckState(TreeItem* item, Qt::CheckState newState) {
+	GTestExecutable* gtest = executableOf(item);
+	if(!gtest)
 		return false;
-	bool retval;
-	if(newState == Qt::Checked || newState == Qt::Unchecked) {
-		if(recursionDirection & TO_CHILDREN)
-			for(int i=0,j=item->childCount();i<j;i++)
-				setCheckState(item->child(i), newState, TO_CHILDREN);
-
-		retval = item->setData(QVariant(static_cast<int>(newState)), 0, Qt::CheckStateRole);
-		if(recursionDirection & TO_PARENT) {
-			setCheckState(item->parent(), Qt::PartiallyChecked, TO_PARENT);
-		}
+	TestStore& store = gtest->getStore();
+	LEVEL level = levelOf(item);
+	if(newState == Qt::PartiallyChecked) {
+		Qt::CheckState state = static_cast<Qt::CheckState>(data(createIndex(item->row(), 0, item), Qt::CheckStateRole).value<int>());
+		newState = (state == Qt::Checked) ? Qt::Unchecked : Qt::Checked;
 	}
-	else /*newState == Qt::PartiallyChecked*/ {
-		bool checked = false;
-		bool unchecked = false;
-		Qt::CheckState childState;
-		for(int i=0,j=item->childCount();i<j&&(!checked||!unchecked);i++) {
-			childState = static_cast<Qt::CheckState>(item->child(i)->data(0, Qt::CheckStateRole).value<int>());
-			if(childState == Qt::Checked)
-				checked = true;
-			else if(childState == Qt::Unchecked)
-				unchecked = true;
-		}
-		if(recursionDirection == (TO_PARENT | TO_CHILDREN)) {
-			if(checked && !unchecked)
-				newState = Qt::Unchecked;
-			else if(!checked && unchecked)
-				newState = Qt::Checked;
-			for(int i=0,j=item->childCount();i<j;i++)
-				setCheckState(item->child(i), newState, TO_CHILDREN);
-			retval = item->setData(QVariant(static_cast<int>(newState)), 0, Qt::CheckStateRole);
-		}
-		else {
-			if(checked && !unchecked)
-				newState = Qt::Checked; //only checked children
-			else if(!checked && unchecked)
-				newState = Qt::Unchecked; //only unchecked children
-			retval = item->setData(QVariant(static_cast<int>(newState)), 0, Qt::CheckStateRole);
-		}
-		if(recursionDirection & TO_PARENT) {
-			setCheckState(item->parent(), Qt::PartiallyChecked, TO_PARENT);
-		}
+	switch(level) {
+	case EXECUTABLE:
+		store.setCheckState(newState);
+		break;
+	case SUITE:
+		store.setSuiteCheckState(item->getId(), newState);
+		break;
+	case TEST:
+		store.setTestCheckState(item->getId(), newState);
+		break;
+	default:
+		return false;
 	}
-	QModelIndex index(createIndex(item->row(),0,item));
-	emit dataChanged(index, index);
-	return retval;
+	emitChanged(item, TO_PARENT | TO_CHILDREN);
+	return true;
+}
+
+/*! \brief Appends the attributes and failure messages of results to the sources of the result pane.
+ *
+ * Each failure message is a source of its own, which is only encoded and
+ * indexed once the pane shows its lines.
+ */
+static void appendResultSources(QList<LogSourcePointer>& sources, const GTestResults* results) {
+    sources << LogSourcePointer(new TextLogSource(results->serialiseAttributes().toLocal8Bit()));
+    QStringList messages = results->getFailureMessages();
+    for(int i = 0; i < messages.size(); ++i)
+        sources << LogSourcePointer(new MessageLogSource(messages.at(i), results->getFailureLineCount(i)));
 }
 
 /*! \brief Populate the result pane.
  *
+ * For a test, the results of its previous run and the console output it
+ * printed in the last run follow its results. Only the test's own range of
+ * its shard's output is read, and the pane only reads the lines it shows,
+ * so selecting a test costs the same however long its failure messages
+ * and its output are.
  */
 void  TestTreeModel::printResult ( const QModelIndex & selected, const QModelIndex & deselected ){
     Q_UNUSED(deselected);
-    QString Result;
+    QList<LogSourcePointer> sources;
 
     TreeItem *treeItem = static_cast<TreeItem*>(selected.internalPointer());
-    if(treeItem != 0){
-        QVariant var = treeItem->data(0, Qt::UserRole);
-        GTest* testItem = var.value<GTest*>();
-        if(testItem != 0){
-            GTestResults* testResults = testItem->getTestResults();
-            if(testResults != 0){
-                Result = testResults->serialiseAttributes();
-                QStringList messageList = testResults->getFailureMessages();
-                int ii = 0;
-                while(messageList.count()>ii){
-                    Result.append(messageList.at(ii++));
-                }
+    GTestExecutable* gtest = executableOf(treeItem);
+    if(gtest != 0){
+        GTestResults* testResults = 0;
+        switch(levelOf(treeItem)) {
+        case EXECUTABLE:
+            testResults = gtest->getTestResults();
+            break;
+        case SUITE:
+            testResults = gtest->getTestResults(GTestSuite(&gtest->getStore(), treeItem->getId()));
+            break;
+        case TEST:
+            testResults = gtest->getTestResults(GTest(&gtest->getStore(), treeItem->getId()));
+            break;
+        default:
+            break;
+        }
+        if(testResults != 0)
+            appendResultSources(sources, testResults);
+        if(levelOf(treeItem) == TEST) {
+            GTest test(&gtest->getStore(), treeItem->getId());
+            GTestResults* previous = gtest->getPreviousResults(test);
+            if(previous != 0){
+                sources << LogSourcePointer(new TextLogSource("\nPrevious run:\n"));
+                appendResultSources(sources, previous);
             }
+            sources << gtest->getTestOutput(test);
         }
     }
-    m_result->setPlainText(Result);
+    m_result->setSource(LogSourcePointer(new ConcatenatedLogSource(sources)));
 }
 
 void TestTreeModel::removeSelectedTests() {
 	QModelIndexList selectedIndexes = this->selectionModel->selectedIndexes();
+	QList<GTestExecutable* > executables;
 	QModelIndexList::iterator it = selectedIndexes.begin();
 	for(; it != selectedIndexes.end(); ++it) {
 		TreeItem* item = static_cast<TreeItem*>(it->internalPointer());
 		if(!item)
 			continue;
-		GTest* gtest = item->data(0, Qt::UserRole).value<GTest*>();
-		GTestExecutable* gtestExe = dynamic_cast<GTestExecutable*>(gtest);
-		if(!gtestExe) {
+		if(levelOf(item) != EXECUTABLE) {
 			QWidget* parent = 0;
 			if(QObject::parent()->isWidgetType())
 				parent = static_cast<QWidget*>(QObject::parent());
 			QMessageBox::information(parent, "Info", "Currently, only top level tests can be removed.", QMessageBox::Ok);
 			continue;
 		}
-		this->beginRemoveRows(this->createIndex(0, 0, &rootItem), item->row(), item->row());
-		item->parent()->removeChild(item);
-		this->testExeHash.remove(gtest->objectName());
-		this->endRemoveRows();
+		if(!executables.contains(executableOf(item)))
+			executables << executableOf(item);
+	}
+	//The items are only deleted once no selected index refers to them.
+	GTestExecutable* gtestExe;
+	bool running = !m_RunJobs.isEmpty();
+	foreach(gtestExe, executables) {
+		int job;
+		foreach(job, m_RunJobs.keys(gtestExe))
+			m_RunJobs.remove(job);
+		m_EndedTests.remove(gtestExe);
+		if(m_BegunExecutable == gtestExe)
+			m_BegunExecutable = 0;
+		this->removeItems(itemExeHash.take(gtestExe)->row(), 1, &rootItem);
+		this->testExeHash.remove(gtestExe->objectName());
 	}
+	if(running && m_RunJobs.isEmpty())
+		emit allTestsCompleted();
 }
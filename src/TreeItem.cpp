@@ -20,7 +20,7 @@
  *
  */
 TreeItem::TreeItem()
- : childItems(), itemData(), parentItem(0)
+ : childItems(), itemData(), parentItem(0), id(-1), itemRow(0)
 {}
 
 /*! \brief Constructor
@@ -30,23 +30,66 @@ TreeItem::TreeItem()
  * \param parent The parent of this item.
  */
 TreeItem::TreeItem(QList<QMap<int, QVariant> >& data, TreeItem* parent)
-: childItems(), itemData(data), parentItem(parent)
+: childItems(), itemData(data), parentItem(parent), id(-1), itemRow(0)
 {}
 
-/*! \brief Destructor
+/*! \brief Constructor
  *
+ * Creates an item that holds no data of its own. This keeps the items of
+ * very large models small, as their data is looked up by the model instead.
+ * \param id The id the model identifies the item's data by.
+ * \param parent The parent of this item.
  */
-TreeItem::~TreeItem()
+TreeItem::TreeItem(int id, TreeItem* parent)
+: childItems(), itemData(), parentItem(parent), id(id), itemRow(0)
 {}
 
+/*! \brief Destructor
+ *
+ * Deletes the children still held by this item.
+ */
+TreeItem::~TreeItem() {
+	qDeleteAll(childItems);
+}
+
 /*! \brief Appends the child to the end of this item.
  *
- * \param child A pointer to the child to append.
+ * \param child A pointer to the child to append. It should not have a parent yet.
  */
 void TreeItem::appendChild(TreeItem* child) {
+	child->setParent(this);
+	child->itemRow = childItems.size();
 	childItems.append(child);
 }
 
+/*! \brief Inserts several children in this item before the item indexed at row.
+ *
+ * The children keep their order and the first one becomes row 'row'.
+ * If the index is greater than the number of children, or less than 0,
+ * this function does nothing and returns false.
+ * \param row The row to insert the children before.
+ * \param children The children to insert. They should not have a parent yet.
+ * \return true if the children were successfully inserted, false otherwise.
+ */
+bool TreeItem::insertChildren(int row, const QList<TreeItem* >& children) {
+	if(row < 0 || row > childItems.size())
+		return false;
+	if(row == childItems.size()) {
+		TreeItem* child;
+		foreach(child, children)
+			appendChild(child);
+		return true;
+	}
+	QList<TreeItem* > tail = childItems.mid(row);
+	childItems.erase(childItems.begin() + row, childItems.end());
+	childItems.reserve(childItems.size() + children.size() + tail.size());
+	TreeItem* child;
+	foreach(child, children)
+		appendChild(child);
+	childItems.append(tail);
+	return true;
+}
+
 /*! \brief Retrieves the data item specified by the role (a Qt::ItemDataRole).
  *
  * \param role A value from Qt::ItemDataRole specifying a model role.
@@ -70,17 +113,31 @@ TreeItem* TreeItem::parent() {
  *
  * The row is relative to the parent. The row this item is in,
  * is the index of the item in the children of its parent.
+ * The row is cached, so this is a constant time check unless a sibling
+ * before this item has been inserted or removed since. In that case the
+ * rows of all the siblings are refreshed at once.
  * \return The row this item is in, or if it has no parent (the rootItem. 0.
+ * 		   -1 if the item is no longer a child of its parent.
  */
 int TreeItem::row() const {
 	if(parentItem) {
-		TreeItem* item(const_cast<TreeItem*>(this));
-		int row = parentItem->childItems.indexOf(item);
-		return row;
+		if(parentItem->childItems.value(itemRow) != this) {
+			parentItem->renumberChildren();
+			if(parentItem->childItems.value(itemRow) != this)
+				return -1;
+		}
+		return itemRow;
 	}
 	return 0;
 }
 
+/*! \brief Refreshes the cached row of every child of this item.
+ */
+void TreeItem::renumberChildren() {
+	for(int i = 0; i < childItems.size(); ++i)
+		childItems.at(i)->itemRow = i;
+}
+
 /*! \brief Sets the data for the given role to the variant 'value'.
  *
  * \param value The value to set for the given role.
@@ -85,7 +85,7 @@ Qt::ItemFlags TreeModel::flags(const QModelIndex& index) const {
 
 	Qt::ItemFlags flags = Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsUserCheckable;
 
-	if(static_cast<TreeItem*>(index.internalPointer())->childCount() > 0)
+	if(hasChildren(index))
 		flags |= Qt::ItemIsTristate;
 
 	return flags;
@@ -189,6 +189,16 @@ void TreeModel::setSelectionModel(QItemSelectionModel *model) {
 }
 
 
+/*! \brief Retrieves the model index of an item.
+ *
+ * \return The index of the item, or an invalid index for the root item.
+ */
+QModelIndex TreeModel::indexOf(TreeItem* item) const {
+	if(!item || item == &rootItem)
+		return QModelIndex();
+	return createIndex(item->row(), 0, item);
+}
+
 /*! \brief Inserts a single item into the model before row 'row' on the parent given.
  *
  * If the parent, or the item is null, this function does nothing and returns false.
@@ -197,10 +207,43 @@ void TreeModel::setSelectionModel(QItemSelectionModel *model) {
  * \return true if the item was inserted successfully, false otherwise.
  */
 bool TreeModel::insertItem(TreeItem* item, int row, TreeItem* parent) {
-	if(!item || !parent)
+	if(!item || !parent || row < 0 || row > parent->childCount())
 		return false;
-	beginInsertRows(createIndex(parent->row(), 0, parent), row, row+1);
+	beginInsertRows(indexOf(parent), row, row);
 	parent->insertChild(row, item);
 	endInsertRows();
 	return true;
 }
+
+/*! \brief Inserts several items into the model before row 'row' on the parent given.
+ *
+ * The items, which may already have children of their own, are published
+ * with a single pair of QAbstractItemModel signals however many there are.
+ * \return true if the items were inserted successfully, false otherwise.
+ */
+bool TreeModel::insertItems(const QList<TreeItem* >& items, int row, TreeItem* parent) {
+	if(!parent || row < 0 || row > parent->childCount())
+		return false;
+	if(items.isEmpty())
+		return true;
+	beginInsertRows(indexOf(parent), row, row + items.size() - 1);
+	parent->insertChildren(row, items);
+	endInsertRows();
+	return true;
+}
+
+/*! \brief Removes and deletes 'count' items from row 'row' on the parent given.
+ *
+ * The items are retracted with a single pair of QAbstractItemModel signals.
+ * \return true if the items were removed, false if the range is invalid.
+ */
+bool TreeModel::removeItems(int row, int count, TreeItem* parent) {
+	if(!parent || row < 0 || count <= 0 || row + count > parent->childCount())
+		return false;
+	QList<TreeItem* > items = parent->children().mid(row, count);
+	beginRemoveRows(indexOf(parent), row, row + count - 1);
+	parent->removeChildren(row, count);
+	endRemoveRows();
+	qDeleteAll(items);
+	return true;
+}
@@ -30,6 +30,16 @@ int main(int argc, char *argv[])
     parser.addOption(testExecutablePath);
     QCommandLineOption testOutputPath(QStringList() << "o" << "output-directory", "Specify a directory to store the result xml.", "outputDir");
     parser.addOption(testOutputPath);
+    QCommandLineOption shardCount(QStringList() << "j" << "shards", "Specify the number of processes each executable is split across (defaults to the core count).", "count");
+    parser.addOption(shardCount);
+    QCommandLineOption maxProcesses(QStringList() << "p" << "processes", "Specify the maximum number of test processes running at once (defaults to the core count).", "count");
+    parser.addOption(maxProcesses);
+    QCommandLineOption hashListings(QStringList() << "hash-listings", "Identify executables without an ELF build-id by a hash of their contents when checking the listing cache.");
+    parser.addOption(hashListings);
+    QCommandLineOption jsonResults(QStringList() << "json", "Have the executables write their results as JSON rather than XML (needs googletest 1.8.1 or later).");
+    parser.addOption(jsonResults);
+    QCommandLineOption keptRuns(QStringList() << "keep-runs", "Specify the number of previous runs whose results are kept for comparison (defaults to 1).", "count");
+    parser.addOption(keptRuns);
 
     parser.process(a);
 
@@ -42,6 +52,19 @@ int main(int argc, char *argv[])
         }
     }
 
+    // Set the shard count before the executable for the same reason.
+    if(parser.isSet(shardCount)){
+        w.SetShardCount(parser.value(shardCount).toInt());
+    }
+    if(parser.isSet(maxProcesses)){
+        w.SetMaxProcesses(parser.value(maxProcesses).toInt());
+    }
+    w.SetHashListings(parser.isSet(hashListings));
+    w.SetJsonResults(parser.isSet(jsonResults));
+    if(parser.isSet(keptRuns)){
+        w.SetKeptRuns(parser.value(keptRuns).toInt());
+    }
+
     // If a filename was passed on the command line, add the tests immediately.
     QString targetFile = parser.value(testExecutablePath);
     if(QFile::exists(targetFile)){
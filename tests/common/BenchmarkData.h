@@ -0,0 +1,35 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * BenchmarkData.h - Created on 2026-10-17
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef BENCHMARKDATA_H_
+#define BENCHMARKDATA_H_
+
+#include <QtTest>
+
+/*! \brief The number of tests in each suite of the listings, outputs and reports the benchmarks generate.
+ */
+static const int TESTS_PER_SUITE = 100;
+
+/*! \brief Adds an int column named 'column' with rows of 1k, 10k and 100k.
+ */
+inline void addSizeRows(const char* column) {
+	QTest::addColumn<int>(column);
+	QTest::newRow("1k") << 1000;
+	QTest::newRow("10k") << 10000;
+	QTest::newRow("100k") << 100000;
+}
+
+#endif /* BENCHMARKDATA_H_ */
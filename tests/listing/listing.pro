@@ -0,0 +1,53 @@
+include(../tests.pri)
+QT += widgets xml network concurrent
+TARGET = tst_listing
+HEADERS += ../../include/GTestSuiteResults.h \
+    ../../include/GTestResults.h \
+    ../../include/GTestSuite.h \
+    ../../include/Defines.h \
+    ../../include/GTestExecutableResults.h \
+    ../../include/GTest.h \
+    ../../include/GTestExecutable.h \
+    ../../include/GTestParser.h \
+    ../../include/TestTreeModel.h \
+    ../../include/TreeModel.h \
+    ../../include/TreeItem.h \
+    ../../include/TestScheduler.h \
+    ../../include/TestHistory.h \
+    ../../include/TestPartitioner.h \
+    ../../include/GTestFilter.h \
+    ../../include/ListingCache.h \
+    ../../include/TestStore.h \
+    ../../include/TestEngine.h \
+    ../../include/TestEventRecord.h \
+    ../../include/OutputCapture.h \
+    ../../include/LogSource.h \
+    ../../include/LogView.h \
+    ../../include/JsonStreamReader.h \
+    ../../include/GTestJsonParser.h \
+    ../../include/ResultArena.h \
+    ../common/BenchmarkData.h
+SOURCES += tst_listing.cpp \
+    ../../src/GTestResults.cpp \
+    ../../src/GTestSuiteResults.cpp \
+    ../../src/GTestSuite.cpp \
+    ../../src/GTestExecutableResults.cpp \
+    ../../src/GTest.cpp \
+    ../../src/GTestExecutable.cpp \
+    ../../src/GTestParser.cpp \
+    ../../src/TestTreeModel.cpp \
+    ../../src/TreeModel.cpp \
+    ../../src/TreeItem.cpp \
+    ../../src/TestScheduler.cpp \
+    ../../src/TestHistory.cpp \
+    ../../src/TestPartitioner.cpp \
+    ../../src/GTestFilter.cpp \
+    ../../src/ListingCache.cpp \
+    ../../src/TestStore.cpp \
+    ../../src/TestEngine.cpp \
+    ../../src/OutputCapture.cpp \
+    ../../src/LogSource.cpp \
+    ../../src/LogView.cpp \
+    ../../src/JsonStreamReader.cpp \
+    ../../src/GTestJsonParser.cpp \
+    ../../src/ResultArena.cpp
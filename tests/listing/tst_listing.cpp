@@ -0,0 +1,165 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * tst_listing.cpp - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <QFile>
+#include <QList>
+#include <QMainWindow>
+#include <QSignalSpy>
+#include <QSortFilterProxyModel>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "LogView.h"
+#include "TestTreeModel.h"
+#include "TreeItem.h"
+#include "TreeModel.h"
+#include "../common/BenchmarkData.h"
+
+/*! \brief A TreeModel that the benchmark fills in, either a row at a time or a parent at a time.
+ */
+class ListingTreeModel : public TreeModel {
+
+public:
+	void insertPerRow(int suites);
+	void insertPerParent(int suites);
+};
+
+/*! \brief Inserts the suites and tests with a pair of insertion signals per item.
+ *
+ * This is how listings were published before they were built off-model.
+ */
+void ListingTreeModel::insertPerRow(int suites) {
+	for(int suite = 0; suite < suites; ++suite) {
+		TreeItem* suiteItem = new TreeItem(suite);
+		insertItem(suiteItem, rootItem.childCount(), &rootItem);
+		for(int test = 0; test < TESTS_PER_SUITE; ++test)
+			insertItem(new TreeItem(suite * TESTS_PER_SUITE + test), test, suiteItem);
+	}
+}
+
+/*! \brief Builds the suites and tests off-model and publishes them with a single insertion.
+ */
+void ListingTreeModel::insertPerParent(int suites) {
+	QList<TreeItem* > suiteItems;
+	for(int suite = 0; suite < suites; ++suite) {
+		TreeItem* suiteItem = new TreeItem(suite);
+		QList<TreeItem* > testItems;
+		for(int test = 0; test < TESTS_PER_SUITE; ++test)
+			testItems << new TreeItem(suite * TESTS_PER_SUITE + test);
+		suiteItem->insertChildren(0, testItems);
+		suiteItems << suiteItem;
+	}
+	insertItems(suiteItems, rootItem.childCount(), &rootItem);
+}
+
+/*! \brief Benchmarks publishing the listing of an executable to the test tree.
+ *
+ * The insertion benchmark compares publishing the items of a listing a row
+ * at a time, as before, with publishing them a parent at a time. A sorting
+ * proxy stands in for the views, which do work for every insertion signal.
+ * The load benchmark measures the whole of loading an executable into a
+ * TestTreeModel, from listing its tests to the listing's items being
+ * inserted, with a script printing a --gtest_list_tests listing standing in
+ * for the executable. It needs a Unix shell and, without a display, should
+ * be run with QT_QPA_PLATFORM=offscreen.
+ */
+class ListingBenchmark : public QObject {
+
+	Q_OBJECT
+
+private slots:
+	void initTestCase();
+	void insertion_data();
+	void insertion();
+	void load_data();
+	void load();
+};
+
+/*! \brief Keeps the listing cache and duration history of the benchmark apart from the user's.
+ */
+void ListingBenchmark::initTestCase() {
+	QStandardPaths::setTestModeEnabled(true);
+}
+
+void ListingBenchmark::insertion_data() {
+	QTest::addColumn<int>("tests");
+	QTest::addColumn<bool>("perRow");
+	QTest::newRow("10k per row") << 10000 << true;
+	QTest::newRow("10k per parent") << 10000 << false;
+	QTest::newRow("50k per row") << 50000 << true;
+	QTest::newRow("50k per parent") << 50000 << false;
+}
+
+/*! \brief Measures publishing the items of a listing to a model that a proxy follows.
+ */
+void ListingBenchmark::insertion() {
+	QFETCH(int, tests);
+	QFETCH(bool, perRow);
+	QBENCHMARK {
+		ListingTreeModel model;
+		QSortFilterProxyModel proxy;
+		proxy.setSourceModel(&model);
+		proxy.sort(0);
+		if(perRow)
+			model.insertPerRow(tests / TESTS_PER_SUITE);
+		else
+			model.insertPerParent(tests / TESTS_PER_SUITE);
+	}
+}
+
+void ListingBenchmark::load_data() {
+	QTest::addColumn<int>("tests");
+	QTest::newRow("10k") << 10000;
+	QTest::newRow("50k") << 50000;
+}
+
+/*! \brief Measures loading an executable into the test tree, from its listing to its items.
+ *
+ * Each row lists a new script, so the listing cache never short-cuts it.
+ */
+void ListingBenchmark::load() {
+#ifndef Q_OS_UNIX
+	QSKIP("The listing is generated by a shell script.");
+#endif
+	QFETCH(int, tests);
+	QTemporaryDir directory;
+	QVERIFY(directory.isValid());
+	QString script = directory.path() + "/listing.sh";
+	QFile file(script);
+	QVERIFY(file.open(QIODevice::WriteOnly));
+	file.write(QString("#!/bin/sh\n"
+					   "awk 'BEGIN { for(s = 0; s < %1; s++) { printf \"Suite%%d.\\n\", s; "
+					   "for(t = 0; t < %2; t++) printf \"  Test%%d\\n\", t } }'\n")
+			   .arg(tests / TESTS_PER_SUITE).arg(TESTS_PER_SUITE).toLatin1());
+	file.close();
+	QVERIFY(file.setPermissions(file.permissions() | QFile::ExeUser));
+
+	QMainWindow window;
+	LogView result;
+	TestTreeModel model(&window, &result);
+	QSignalSpy inserted(&model, SIGNAL(rowsInserted(QModelIndex, int, int)));
+	QBENCHMARK_ONCE {
+		QCOMPARE(model.addDataSource(script, directory.path()), TestTreeModel::NO_ERROR);
+		QVERIFY(inserted.wait(60000));
+	}
+	QModelIndex executable = model.index(0, 0);
+	QCOMPARE(model.rowCount(executable), tests / TESTS_PER_SUITE);
+}
+
+QTEST_MAIN(ListingBenchmark)
+
+#include "tst_listing.moc"
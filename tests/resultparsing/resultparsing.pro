@@ -0,0 +1,26 @@
+include(../tests.pri)
+QT -= gui
+QT += network xml concurrent
+TARGET = tst_resultparsing
+HEADERS += ../../include/TestEngine.h \
+    ../../include/GTestParser.h \
+    ../../include/GTestJsonParser.h \
+    ../../include/JsonStreamReader.h \
+    ../../include/GTestExecutableResults.h \
+    ../../include/GTestSuiteResults.h \
+    ../../include/GTestResults.h \
+    ../../include/ResultArena.h \
+    ../../include/OutputCapture.h \
+    ../../include/TestEventRecord.h \
+    ../common/BenchmarkData.h \
+    ../common/MemoryUsage.h
+SOURCES += tst_resultparsing.cpp \
+    ../../src/TestEngine.cpp \
+    ../../src/GTestParser.cpp \
+    ../../src/GTestJsonParser.cpp \
+    ../../src/JsonStreamReader.cpp \
+    ../../src/GTestExecutableResults.cpp \
+    ../../src/GTestSuiteResults.cpp \
+    ../../src/GTestResults.cpp \
+    ../../src/ResultArena.cpp \
+    ../../src/OutputCapture.cpp
@@ -0,0 +1,265 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * tst_resultparsing.cpp - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <QFile>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "GTestExecutableResults.h"
+#include "GTestSuiteResults.h"
+#include "TestEngine.h"
+#include "../common/BenchmarkData.h"
+#include "../common/MemoryUsage.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/*! \brief One test in this many fails, with a single failure message.
+ */
+static const int FAILING_TEST_INTERVAL = 10;
+
+/*! \brief The timestamp written on the run, each suite and each test.
+ */
+static const char TIMESTAMP[] = "2026-10-16T12:00:00.123";
+
+/*! \brief Writes the .xml report of a run of 'tests' tests to 'path'.
+ */
+static bool writeXmlReport(const QString& path, int tests) {
+	QFile file(path);
+	if(!file.open(QIODevice::WriteOnly))
+		return false;
+	int suites = (tests + TESTS_PER_SUITE - 1) / TESTS_PER_SUITE;
+	file.write(QString("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+					   "<testsuites tests=\"%1\" failures=\"%2\" disabled=\"0\" errors=\"0\" time=\"1.5\" timestamp=\"%3\" name=\"AllTests\">\n")
+			   .arg(tests).arg(tests / FAILING_TEST_INTERVAL).arg(TIMESTAMP).toUtf8());
+	for(int suite = 0; suite < suites; ++suite) {
+		QByteArray chunk;
+		chunk += QString("  <testsuite name=\"Suite%1\" tests=\"%2\" failures=\"%3\" disabled=\"0\" errors=\"0\" time=\"0.1\" timestamp=\"%4\">\n")
+				 .arg(suite).arg(TESTS_PER_SUITE).arg(TESTS_PER_SUITE / FAILING_TEST_INTERVAL).arg(TIMESTAMP).toUtf8();
+		for(int test = 0; test < TESTS_PER_SUITE && suite * TESTS_PER_SUITE + test < tests; ++test) {
+			chunk += QString("    <testcase name=\"Test%1\" status=\"run\" result=\"completed\" time=\"0.001\" timestamp=\"%2\" classname=\"Suite%3\"")
+					 .arg(test).arg(TIMESTAMP).arg(suite).toUtf8();
+			if(test % FAILING_TEST_INTERVAL == 0)
+				chunk += ">\n      <failure message=\"suite.cpp:42&#x0A;Value of: result&#x0A;  Actual: false&#x0A;Expected: true\" type=\"\">"
+						 "<![CDATA[suite.cpp:42\nValue of: result\n  Actual: false\nExpected: true]]></failure>\n    </testcase>\n";
+			else
+				chunk += " />\n";
+		}
+		chunk += "  </testsuite>\n";
+		file.write(chunk);
+	}
+	file.write("</testsuites>\n");
+	return true;
+}
+
+/*! \brief Writes the .json report of a run of 'tests' tests to 'path'.
+ */
+static bool writeJsonReport(const QString& path, int tests) {
+	QFile file(path);
+	if(!file.open(QIODevice::WriteOnly))
+		return false;
+	int suites = (tests + TESTS_PER_SUITE - 1) / TESTS_PER_SUITE;
+	file.write(QString("{\n  \"tests\": %1,\n  \"failures\": %2,\n  \"disabled\": 0,\n  \"errors\": 0,\n"
+					   "  \"timestamp\": \"%3Z\",\n  \"time\": \"1.5s\",\n  \"name\": \"AllTests\",\n  \"testsuites\": [\n")
+			   .arg(tests).arg(tests / FAILING_TEST_INTERVAL).arg(TIMESTAMP).toUtf8());
+	for(int suite = 0; suite < suites; ++suite) {
+		QByteArray chunk;
+		chunk += QString("    {\n      \"name\": \"Suite%1\",\n      \"tests\": %2,\n      \"failures\": %3,\n      \"disabled\": 0,\n"
+						 "      \"errors\": 0,\n      \"timestamp\": \"%4Z\",\n      \"time\": \"0.1s\",\n      \"testsuite\": [\n")
+				 .arg(suite).arg(TESTS_PER_SUITE).arg(TESTS_PER_SUITE / FAILING_TEST_INTERVAL).arg(TIMESTAMP).toUtf8();
+		for(int test = 0; test < TESTS_PER_SUITE && suite * TESTS_PER_SUITE + test < tests; ++test) {
+			if(test > 0)
+				chunk += ",\n";
+			chunk += QString("        {\n          \"name\": \"Test%1\",\n          \"status\": \"RUN\",\n          \"result\": \"COMPLETED\",\n"
+							 "          \"timestamp\": \"%2Z\",\n          \"time\": \"0.001s\",\n          \"classname\": \"Suite%3\"")
+					 .arg(test).arg(TIMESTAMP).arg(suite).toUtf8();
+			if(test % FAILING_TEST_INTERVAL == 0)
+				chunk += ",\n          \"failures\": [\n            {\n"
+						 "              \"failure\": \"suite.cpp:42\\nValue of: result\\n  Actual: false\\nExpected: true\",\n"
+						 "              \"type\": \"\"\n            }\n          ]";
+			chunk += "\n        }";
+		}
+		chunk += suite + 1 < suites ? "\n      ]\n    },\n" : "\n      ]\n    }\n";
+		file.write(chunk);
+	}
+	file.write("  ]\n}\n");
+	return true;
+}
+
+/*! \brief Counts the tests in a tree of results.
+ */
+static int countTests(const GTestExecutableResults* results) {
+	int tests = 0;
+	foreach(GTestResults* suite, results->getTestResultsList())
+		tests += static_cast<GTestSuiteResults*>(suite)->getTestResultsList().size();
+	return tests;
+}
+
+/*! \brief Discards the messages the parsers log while the reports are parsed.
+ */
+static void discardMessage(QtMsgType, const QMessageLogContext&, const QString&) {
+}
+
+/*! \brief Benchmarks parsing the .xml and .json reports of gtest.
+ *
+ * Both reports of the same run are generated in a temporary directory and
+ * parsed with TestEngine::parseResultFile(), as a finished run is. The parse
+ * benchmark measures the time each takes and the peak memory benchmark the
+ * most memory the process holds while parsing each, as the growth of the
+ * peak resident set size of a forked process that parses the report over
+ * that of a forked process that doesn't. It needs fork() and is skipped
+ * where it isn't available. The memory benchmark measures the heap bytes
+ * per test that the parsed tree of typed, interned records keeps once
+ * parsing is done, which is what the results of every run hold on to.
+ */
+class ResultParsingBenchmark : public QObject {
+
+	Q_OBJECT
+
+private:
+	QTemporaryDir directory;	//!< Holds the generated reports.
+	QtMessageHandler handler;	//!< The message handler replaced while parsing.
+
+	QString reportPath(const QString& format, int tests) const;
+
+private slots:
+	void initTestCase();
+	void init();
+	void cleanup();
+	void parse_data();
+	void parse();
+	void peakMemory_data();
+	void peakMemory();
+	void memory_data();
+	void memory();
+};
+
+/*! \brief Generates the reports of each size of run the benchmarks parse.
+ */
+void ResultParsingBenchmark::initTestCase() {
+	QVERIFY(directory.isValid());
+	QList<int> sizes;
+	sizes << 500000 << 1000000;
+	foreach(int tests, sizes) {
+		QVERIFY(writeXmlReport(reportPath("xml", tests), tests));
+		QVERIFY(writeJsonReport(reportPath("json", tests), tests));
+	}
+}
+
+void ResultParsingBenchmark::init() {
+	handler = qInstallMessageHandler(discardMessage);
+}
+
+void ResultParsingBenchmark::cleanup() {
+	qInstallMessageHandler(handler);
+}
+
+/*! \brief Retrieves the path of the report of a run of 'tests' tests in 'format'.
+ */
+QString ResultParsingBenchmark::reportPath(const QString& format, int tests) const {
+	return QString("%1/report%2.%3").arg(directory.path()).arg(tests).arg(format);
+}
+
+void ResultParsingBenchmark::parse_data() {
+	QTest::addColumn<QString>("format");
+	QTest::addColumn<int>("tests");
+	QTest::newRow("xml 500k") << "xml" << 500000;
+	QTest::newRow("json 500k") << "json" << 500000;
+	QTest::newRow("xml 1M") << "xml" << 1000000;
+	QTest::newRow("json 1M") << "json" << 1000000;
+}
+
+/*! \brief Measures the time taken to parse a report into a tree of results.
+ */
+void ResultParsingBenchmark::parse() {
+	QFETCH(QString, format);
+	QFETCH(int, tests);
+	QString path = reportPath(format, tests);
+	int parsed = 0;
+	QBENCHMARK_ONCE {
+		GTestExecutableResults* results = TestEngine::parseResultFile(path);
+		parsed = results ? countTests(results) : 0;
+		delete results;
+	}
+	QCOMPARE(parsed, tests);
+}
+
+void ResultParsingBenchmark::peakMemory_data() {
+	parse_data();
+}
+
+/*! \brief Measures the most memory held while a report is parsed.
+ */
+void ResultParsingBenchmark::peakMemory() {
+#ifdef Q_OS_UNIX
+	QFETCH(QString, format);
+	QFETCH(int, tests);
+	QString path = reportPath(format, tests);
+	long maxResidentKiB[2];
+	for(int parsing = 0; parsing < 2; ++parsing) {
+		pid_t child = fork();
+		QVERIFY(child != -1);
+		if(child == 0) {
+			int parsed = 0;
+			if(parsing) {
+				GTestExecutableResults* results = TestEngine::parseResultFile(path);
+				parsed = results ? countTests(results) : 0;
+			}
+			_exit(parsing && parsed != tests ? 1 : 0);
+		}
+		int status;
+		struct rusage usage;
+		QCOMPARE(wait4(child, &status, 0, &usage), child);
+		QVERIFY(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+		maxResidentKiB[parsing] = usage.ru_maxrss;
+	}
+	QTest::setBenchmarkResult((qreal)(maxResidentKiB[1] - maxResidentKiB[0]) * 1024, QTest::BytesAllocated);
+#else
+	QSKIP("The peak memory is measured in a forked process.");
+#endif
+}
+
+void ResultParsingBenchmark::memory_data() {
+	parse_data();
+}
+
+/*! \brief Measures the heap bytes per test held by the tree parsed from a report.
+ */
+void ResultParsingBenchmark::memory() {
+	QFETCH(QString, format);
+	QFETCH(int, tests);
+	qint64 before = allocatedBytes();
+	if(before < 0)
+		QSKIP("The heap usage can't be measured on this platform.");
+	GTestExecutableResults* results = TestEngine::parseResultFile(reportPath(format, tests));
+	qint64 bytes = allocatedBytes() - before;
+	int parsed = results ? countTests(results) : 0;
+	delete results;
+	QCOMPARE(parsed, tests);
+	QTest::setBenchmarkResult((qreal)bytes / tests, QTest::BytesAllocated);
+}
+
+QTEST_APPLESS_MAIN(ResultParsingBenchmark)
+
+#include "tst_resultparsing.moc"
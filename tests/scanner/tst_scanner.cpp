@@ -0,0 +1,148 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * tst_scanner.cpp - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <QByteArray>
+#include <QDebug>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QtTest>
+
+#include <cstring>
+
+#include "TestEngine.h"
+#include "../common/BenchmarkData.h"
+
+/*! \brief The number of tests in the generated output.
+ */
+static const int TESTS = 10000;
+
+/*! \brief Generates the console output of a gtest run of TESTS tests.
+ *
+ * Every other test fails, and each test writes 'outputLines' lines of its own.
+ */
+static QByteArray generateOutput(int outputLines) {
+	QByteArray output;
+	for(int test = 0; test < TESTS; ++test) {
+		QByteArray name = QString("Suite%1.Test%2").arg(test / TESTS_PER_SUITE).arg(test % TESTS_PER_SUITE).toLatin1();
+		output += "[ RUN      ] " + name + "\n";
+		for(int line = 0; line < outputLines; ++line)
+			output += "Some output of the test, line " + QByteArray::number(line) + " of it.\n";
+		if(test % 2)
+			output += "[  FAILED  ] " + name + " (3 ms)\n";
+		else
+			output += "[       OK ] " + name + " (3 ms)\n";
+	}
+	return output;
+}
+
+/*! \brief Discards the messages of the line by line scan.
+ */
+static void discardMessage(QtMsgType, const QMessageLogContext&, const QString&) {
+}
+
+/*! \brief Scans the output the way readExecutableOutput() used to, one QString per line.
+ *
+ * \return The number of progress markers found.
+ */
+static int scanLines(const QByteArray& output) {
+	int markers = 0;
+	int start = 0;
+	int end;
+	while((end = output.indexOf('\n', start)) != -1) {
+		QString line = output.mid(start, end + 1 - start);
+		start = end + 1;
+		if(line.startsWith("[ ")) {
+			qDebug() << line;
+			QString testName = line;
+			testName = testName.remove(0, 13);
+			testName = testName.split(' ').at(0);
+			testName = testName.trimmed();
+			QStringList testsplit = testName.split(".");
+			if(testsplit.size() > 1) {
+				if(line.contains("[ RUN      ]"))
+					++markers;
+				else if(line.contains("[       OK ]"))
+					++markers;
+				else if(line.contains("[  FAILED  ]"))
+					++markers;
+			}
+		}
+	}
+	return markers;
+}
+
+/*! \brief Scans the output in place with TestEngine::scanLine().
+ *
+ * \return The number of progress markers found.
+ */
+static int scanBytes(const QByteArray& output) {
+	int markers = 0;
+	const char* line = output.constData();
+	const char* end = line + output.size();
+	TestEvent event;
+	while(const char* newline = static_cast<const char*>(memchr(line, '\n', end - line))) {
+		if(TestEngine::scanLine(line, newline, &event))
+			++markers;
+		line = newline + 1;
+	}
+	return markers;
+}
+
+/*! \brief Benchmarks scanning the console output of gtest for progress markers.
+ *
+ * The engine scans the raw bytes of the output in place with memchr() and
+ * memcmp(). The former line by line scan copied every line into a
+ * QString, logged it and split it. Both are run on the output of quiet
+ * tests, where the markers are most of the lines, and of chatty tests,
+ * where the cost of the lines without markers dominates.
+ */
+class ScannerBenchmark : public QObject {
+
+	Q_OBJECT
+
+private slots:
+	void scan_data();
+	void scan();
+};
+
+void ScannerBenchmark::scan_data() {
+	QTest::addColumn<int>("outputLines");
+	QTest::addColumn<bool>("inPlace");
+	QTest::newRow("quiet line by line") << 0 << false;
+	QTest::newRow("quiet in place") << 0 << true;
+	QTest::newRow("chatty line by line") << 50 << false;
+	QTest::newRow("chatty in place") << 50 << true;
+}
+
+/*! \brief Measures finding the 2 markers of each of TESTS tests.
+ */
+void ScannerBenchmark::scan() {
+	QFETCH(int, outputLines);
+	QFETCH(bool, inPlace);
+	QByteArray output = generateOutput(outputLines);
+	int markers = 0;
+	QtMessageHandler handler = qInstallMessageHandler(discardMessage);
+	QBENCHMARK {
+		markers = inPlace ? scanBytes(output) : scanLines(output);
+	}
+	qInstallMessageHandler(handler);
+	QCOMPARE(markers, 2 * TESTS);
+}
+
+QTEST_APPLESS_MAIN(ScannerBenchmark)
+
+#include "tst_scanner.moc"
@@ -0,0 +1,9 @@
+# Settings shared by the benchmarks. Each one builds the sources it
+# measures from ../../src rather than linking to the application.
+TEMPLATE = app
+QT += testlib
+CONFIG += testcase console
+CONFIG -= app_bundle
+CONFIG += release
+INCLUDEPATH += $$PWD/../include
+DEPENDPATH += $$PWD/../include $$PWD/../src
@@ -0,0 +1,9 @@
+# The benchmarks of the runner, one QtTest executable per subdirectory.
+# Build them from this directory with qmake && make, and run each one,
+# or all of them with make check.
+TEMPLATE = subdirs
+SUBDIRS += teststore \
+    treemodel \
+    listing \
+    scanner \
+    resultparsing
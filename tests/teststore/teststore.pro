@@ -0,0 +1,10 @@
+include(../tests.pri)
+QT -= gui
+TARGET = tst_teststore
+HEADERS += ../../include/TestStore.h \
+    ../../include/TreeItem.h \
+    ../common/BenchmarkData.h \
+    ../common/MemoryUsage.h
+SOURCES += tst_teststore.cpp \
+    ../../src/TestStore.cpp \
+    ../../src/TreeItem.cpp
@@ -0,0 +1,193 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * tst_teststore.cpp - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QtTest>
+
+#include "TestStore.h"
+#include "TreeItem.h"
+#include "../common/BenchmarkData.h"
+#include "../common/MemoryUsage.h"
+
+/*! \brief Lists 'tests' tests into a store, in suites of TESTS_PER_SUITE.
+ */
+static void listTests(TestStore& store, int tests) {
+	store.beginListing();
+	int suite = -1;
+	for(int test = 0; test < tests; ++test) {
+		if(test % TESTS_PER_SUITE == 0)
+			suite = store.addSuite(QString("Suite%1").arg(test / TESTS_PER_SUITE));
+		store.addTest(suite, QString("Test%1").arg(test % TESTS_PER_SUITE));
+	}
+	store.endListing();
+}
+
+/*! \brief Benchmarks listing tests into the TestStore and finding them by name.
+ *
+ * Every progress event looks its test up with findTest(), a hash lookup
+ * where a recursive QObject::findChild() used to be. The memory benchmark
+ * compares the heap bytes per test of the store with a QObject and a
+ * TreeItem per test.
+ */
+class TestStoreBenchmark : public QObject {
+
+	Q_OBJECT
+
+private:
+	/*! \brief How the tests of a listing are held in memory.
+	 */
+	enum LAYOUT {
+		OBJECT_PER_TEST = 0,	//!< A QObject and a TreeItem holding its own data per test, as before the store.
+		STORE,					//!< The store alone, as when no suite has been expanded.
+		STORE_WITH_ITEMS		//!< The store and an item per test, as when every suite has been expanded.
+	};
+
+private slots:
+	void listing_data();
+	void listing();
+	void findTest_data();
+	void findTest();
+	void relisting_data();
+	void relisting();
+	void memory_data();
+	void memory();
+};
+
+void TestStoreBenchmark::listing_data() {
+	addSizeRows("tests");
+}
+
+/*! \brief Measures listing every test into an empty store.
+ */
+void TestStoreBenchmark::listing() {
+	QFETCH(int, tests);
+	QBENCHMARK {
+		TestStore store;
+		listTests(store, tests);
+	}
+}
+
+void TestStoreBenchmark::findTest_data() {
+	addSizeRows("tests");
+}
+
+/*! \brief Measures looking up every test by its full name, as progress events do.
+ */
+void TestStoreBenchmark::findTest() {
+	QFETCH(int, tests);
+	TestStore store;
+	listTests(store, tests);
+	QStringList names;
+	for(int test = 0; test < tests; ++test)
+		names << store.getTestFullName(test);
+	int found = 0;
+	QBENCHMARK {
+		found = 0;
+		foreach(const QString& name, names)
+			found += store.findTest(name) >= 0 ? 1 : 0;
+	}
+	QCOMPARE(found, tests);
+}
+
+void TestStoreBenchmark::relisting_data() {
+	addSizeRows("tests");
+}
+
+/*! \brief Measures listing the same tests again, which finds every one of them by name.
+ */
+void TestStoreBenchmark::relisting() {
+	QFETCH(int, tests);
+	TestStore store;
+	listTests(store, tests);
+	QBENCHMARK {
+		listTests(store, tests);
+	}
+	QCOMPARE(store.getTestCount(), tests);
+}
+
+void TestStoreBenchmark::memory_data() {
+	QTest::addColumn<int>("layout");
+	QTest::newRow("QObject per test") << (int)OBJECT_PER_TEST;
+	QTest::newRow("store") << (int)STORE;
+	QTest::newRow("store with items") << (int)STORE_WITH_ITEMS;
+}
+
+/*! \brief Measures the heap bytes taken per test by a listing of 100k tests.
+ *
+ * The QObject per test layout rebuilds what a listing cost before the
+ * store: a named QObject per suite and test and a TreeItem per suite and
+ * test holding its name and check state.
+ */
+void TestStoreBenchmark::memory() {
+	QFETCH(int, layout);
+	static const int TESTS = 100000;
+	if(allocatedBytes() < 0)
+		QSKIP("The heap usage can't be measured on this platform.");
+	qint64 before = allocatedBytes();
+	QObject* root = 0;
+	TreeItem* rootItem = 0;
+	TestStore* store = 0;
+	if(layout == OBJECT_PER_TEST) {
+		root = new QObject();
+		rootItem = new TreeItem();
+		QObject* suite = 0;
+		TreeItem* suiteItem = 0;
+		for(int test = 0; test < TESTS; ++test) {
+			QList<QMap<int, QVariant> > data;
+			QMap<int, QVariant> datum;
+			if(test % TESTS_PER_SUITE == 0) {
+				suite = new QObject(root);
+				suite->setObjectName(QString("Suite%1").arg(test / TESTS_PER_SUITE));
+				datum.insert(Qt::DisplayRole, suite->objectName());
+				datum.insert(Qt::CheckStateRole, Qt::Checked);
+				data.append(datum);
+				suiteItem = new TreeItem(data, rootItem);
+				rootItem->appendChild(suiteItem);
+				data.clear();
+			}
+			QObject* object = new QObject(suite);
+			object->setObjectName(QString("Test%1").arg(test % TESTS_PER_SUITE));
+			datum.insert(Qt::DisplayRole, object->objectName());
+			datum.insert(Qt::CheckStateRole, Qt::Checked);
+			data.append(datum);
+			suiteItem->appendChild(new TreeItem(data, suiteItem));
+		}
+	} else {
+		store = new TestStore();
+		listTests(*store, TESTS);
+		if(layout == STORE_WITH_ITEMS) {
+			rootItem = new TreeItem();
+			for(int row = 0; row < store->getSuiteCount(); ++row) {
+				int suite = store->getSuite(row);
+				TreeItem* suiteItem = new TreeItem(suite, rootItem);
+				rootItem->appendChild(suiteItem);
+				for(int testRow = 0; testRow < store->getTestCount(suite); ++testRow)
+					suiteItem->appendChild(new TreeItem(store->getTest(suite, testRow), suiteItem));
+			}
+		}
+	}
+	qint64 bytes = allocatedBytes() - before;
+	delete rootItem;
+	delete root;
+	delete store;
+	QTest::setBenchmarkResult((qreal)bytes / TESTS, QTest::BytesAllocated);
+}
+
+QTEST_APPLESS_MAIN(TestStoreBenchmark)
+
+#include "tst_teststore.moc"
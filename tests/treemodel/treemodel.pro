@@ -0,0 +1,9 @@
+include(../tests.pri)
+QT -= gui
+TARGET = tst_treemodel
+HEADERS += ../../include/TreeModel.h \
+    ../../include/TreeItem.h \
+    ../common/BenchmarkData.h
+SOURCES += tst_treemodel.cpp \
+    ../../src/TreeModel.cpp \
+    ../../src/TreeItem.cpp
@@ -0,0 +1,133 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * tst_treemodel.cpp - Created on 2026-10-16
+ *
+ * Copyright (C) 2010 Sandy Chapman
+ *
+ * This library is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation; either version 2.1 of the License, or (at your option) any later version.
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU Lesser General Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with this
+ * library; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <QList>
+#include <QModelIndex>
+#include <QtTest>
+
+#include "TreeModel.h"
+#include "../common/BenchmarkData.h"
+
+/*! \brief A TreeModel whose items are filled in by the benchmark.
+ */
+class WideTreeModel : public TreeModel {
+
+public:
+	WideTreeModel(int width);
+
+	void insertSuite();
+};
+
+/*! \brief Constructor
+ *
+ * Builds a root with 'width' suites, each with a single test, so that every
+ * parent() of a test looks up the row of its suite among 'width' siblings.
+ */
+WideTreeModel::WideTreeModel(int width)
+: TreeModel()
+{
+	QList<TreeItem* > suites;
+	for(int row = 0; row < width; ++row) {
+		TreeItem* suite = new TreeItem(row);
+		suite->appendChild(new TreeItem(row));
+		suites << suite;
+	}
+	insertItems(suites, 0, &rootItem);
+}
+
+/*! \brief Inserts a suite without tests before the first one.
+ */
+void WideTreeModel::insertSuite() {
+	insertItem(new TreeItem(-1), 0, &rootItem);
+}
+
+/*! \brief Benchmarks index() and parent() of the TreeModel over wide trees.
+ *
+ * parent() takes the row of an item from the row it caches rather than by
+ * searching its siblings, which the views rely on with one suite per row.
+ */
+class TreeModelBenchmark : public QObject {
+
+	Q_OBJECT
+
+private slots:
+	void index_data();
+	void index();
+	void parent_data();
+	void parent();
+	void parentAfterInsert_data();
+	void parentAfterInsert();
+};
+
+void TreeModelBenchmark::index_data() {
+	addSizeRows("width");
+}
+
+/*! \brief Measures creating the index of every suite and of its test.
+ */
+void TreeModelBenchmark::index() {
+	QFETCH(int, width);
+	WideTreeModel model(width);
+	QBENCHMARK {
+		for(int row = 0; row < width; ++row)
+			model.index(0, 0, model.index(row, 0));
+	}
+}
+
+void TreeModelBenchmark::parent_data() {
+	addSizeRows("width");
+}
+
+/*! \brief Measures retrieving the parent of every test.
+ */
+void TreeModelBenchmark::parent() {
+	QFETCH(int, width);
+	WideTreeModel model(width);
+	QList<QModelIndex> tests;
+	for(int row = 0; row < width; ++row)
+		tests << model.index(0, 0, model.index(row, 0));
+	QBENCHMARK {
+		foreach(const QModelIndex& test, tests)
+			model.parent(test);
+	}
+	QCOMPARE(model.parent(tests.last()).row(), width - 1);
+}
+
+void TreeModelBenchmark::parentAfterInsert_data() {
+	addSizeRows("width");
+}
+
+/*! \brief Measures retrieving the parent of every test after a suite is inserted at the top.
+ *
+ * The insertion shifts the row of every suite, so the first lookup
+ * renumbers the suites once and the others are constant time again.
+ */
+void TreeModelBenchmark::parentAfterInsert() {
+	QFETCH(int, width);
+	WideTreeModel model(width);
+	QList<QModelIndex> tests;
+	for(int row = 0; row < width; ++row)
+		tests << model.index(0, 0, model.index(row, 0));
+	QBENCHMARK {
+		model.insertSuite();
+		foreach(const QModelIndex& test, tests)
+			model.parent(test);
+	}
+}
+
+QTEST_APPLESS_MAIN(TreeModelBenchmark)
+
+#include "tst_treemodel.moc"